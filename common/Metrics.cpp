@@ -0,0 +1,183 @@
+#include "Metrics.hpp"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <pthread.h>
+
+bool Metrics::on = false;
+std::string Metrics::tool;
+
+namespace
+{
+    // guards the definitions and the list of thread slots, never held while a metric is recorded
+    pthread_mutex_t registryLock = PTHREAD_MUTEX_INITIALIZER;
+
+    // JSON string without the characters that would need escaping (metric and tool names are plain)
+    void writeName(std::ostream& out, const std::string& name)
+    {
+        out << '"';
+        for (size_t i = 0; i < name.size(); ++i) {
+            if (name[i] != '"' && name[i] != '\\' && static_cast<unsigned char>(name[i]) >= 0x20)
+                out << name[i];
+        }
+        out << '"';
+    }
+}
+
+// slots of the calling thread, NULL until it records its first metric
+static __thread void* currentSlots = NULL;
+
+// function-local statics: define() runs during the static initialization of the other files
+std::vector<Metrics::Definition>& Metrics::definitions()
+{
+    static std::vector<Definition> all;
+    return all;
+}
+
+std::vector<Metrics::ThreadSlots*>& Metrics::threads()
+{
+    static std::vector<ThreadSlots*> all;
+    return all;
+}
+
+// returns the id of the metric, a name that is already defined keeps its id
+size_t Metrics::define(const std::string& name, Kind kind)
+{
+    pthread_mutex_lock(&registryLock);
+    std::vector<Definition>& all = definitions();
+    size_t id = 0;
+    while (id < all.size() && all[id].name != name)
+        ++id;
+    if (id == all.size()) {
+        Definition definition;
+        definition.name = name;
+        definition.kind = kind;
+        all.push_back(definition);
+    }
+    pthread_mutex_unlock(&registryLock);
+    return id;
+}
+
+// turns recording on, the report is written to stderr when the process exits
+void Metrics::enable(const std::string& toolName)
+{
+    if (on)
+        return;
+    on = true;
+    tool = toolName;
+    // both lists have to exist before the exit handler is registered, or they are destroyed before it runs
+    definitions();
+    threads();
+    std::atexit(&Metrics::reportAtExit);
+}
+
+/*
+Handles '--metrics=json' in front of the other arguments: enables the metrics and removes the flag,
+av[0] moves up so the caller sees its usual argument list. Any other format is an error (false).
+*/
+bool Metrics::takeFlag(int& ac, char**& av, const std::string& toolName)
+{
+    if (ac < 2 || std::strncmp(av[1], "--metrics", 9) != 0)
+        return true;
+    if (std::strcmp(av[1], "--metrics=json") != 0) {
+        std::cerr << "Error: unsupported metrics format " << av[1] << " (only --metrics=json)" << std::endl;
+        return false;
+    }
+    enable(toolName);
+    av[1] = av[0];
+    ++av;
+    --ac;
+    return true;
+}
+
+// wall clock that never jumps
+double Metrics::now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// slots of the calling thread, registered on first use and grown to hold the given id
+Metrics::ThreadSlots& Metrics::local(size_t id)
+{
+    ThreadSlots* slots = static_cast<ThreadSlots*>(currentSlots);
+    if (slots == NULL) {
+        slots = new ThreadSlots();
+        pthread_mutex_lock(&registryLock);
+        threads().push_back(slots);
+        pthread_mutex_unlock(&registryLock);
+        currentSlots = slots;
+    }
+    if (slots->calls.size() <= id) {
+        slots->calls.resize(id + 1, 0);
+        slots->seconds.resize(id + 1, 0);
+        slots->values.resize(id + 1, 0);
+    }
+    return *slots;
+}
+
+void Metrics::addTime(size_t id, double seconds)
+{
+    if (!on)
+        return;
+    ThreadSlots& slots = local(id);
+    ++slots.calls[id];
+    slots.seconds[id] += seconds;
+}
+
+// merges the slots of every thread, every defined metric is reported (0 when it never ran)
+void Metrics::writeJson(std::ostream& out)
+{
+    pthread_mutex_lock(&registryLock);
+    const std::vector<Definition>& all = definitions();
+    std::vector<unsigned long> calls(all.size(), 0);
+    std::vector<double> seconds(all.size(), 0);
+    std::vector<unsigned long> values(all.size(), 0);
+    for (size_t t = 0; t < threads().size(); ++t)
+    {
+        const ThreadSlots& slots = *threads()[t];
+        for (size_t id = 0; id < slots.calls.size() && id < all.size(); ++id) {
+            calls[id] += slots.calls[id];
+            seconds[id] += slots.seconds[id];
+            values[id] += slots.values[id];
+        }
+    }
+
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(9) << "{\"tool\": ";
+    writeName(json, tool);
+    json << ", \"threads\": " << threads().size() << ", \"timers\": {";
+    bool first = true;
+    for (size_t id = 0; id < all.size(); ++id)
+    {
+        if (all[id].kind != TIMER)
+            continue;
+        json << (first ? "" : ", ");
+        writeName(json, all[id].name);
+        json << ": {\"calls\": " << calls[id] << ", \"seconds\": " << seconds[id] << "}";
+        first = false;
+    }
+    json << "}, \"counters\": {";
+    first = true;
+    for (size_t id = 0; id < all.size(); ++id)
+    {
+        if (all[id].kind != COUNTER)
+            continue;
+        json << (first ? "" : ", ");
+        writeName(json, all[id].name);
+        json << ": " << values[id];
+        first = false;
+    }
+    json << "}}";
+    pthread_mutex_unlock(&registryLock);
+    out << json.str() << std::endl;
+}
+
+void Metrics::reportAtExit()
+{
+    writeJson(std::cerr);
+}
@@ -0,0 +1,95 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <cstddef>
+
+/*
+Runtime metrics shared by btc (ex00), RPN (ex01) and PmergeMe (ex02):
+
+- timers:   ScopedTimer adds the monotonic wall time of a scope and counts the calls
+- counters: Metrics::add(id, amount)
+- every metric is defined once by name (Metrics::define, usually a static in the .cpp of the
+  hot path) and addressed by the returned id
+
+Threads never share a slot: every thread adds into its own slots (found through a __thread pointer,
+registered once under a lock), the slots of all threads are merged when the report is written.
+Worker threads that already ended keep their slots until then.
+
+Disabled (the default) a timer reads one global flag in its constructor and one member in its
+destructor, a counter reads the flag; no clock is read and nothing is written, so the calls stay
+in the hot paths. '--metrics=json' as the first argument enables the metrics and writes a JSON
+report to stderr when the process exits (stdout keeps the regular output):
+
+    {"tool": "btc", "threads": 1, "timers": {"btc.findClosestDate": {"calls": 3, "seconds": 0.000012}},
+     "counters": {"btc.input_lines": 3}}
+*/
+
+class Metrics
+{
+public:
+    enum Kind { TIMER, COUNTER };
+
+private:
+    struct Definition
+    {
+        std::string name;
+        Kind kind;
+    };
+
+    // one per thread, indexed by metric id
+    struct ThreadSlots
+    {
+        std::vector<unsigned long> calls;
+        std::vector<double> seconds;
+        std::vector<unsigned long> values;
+    };
+
+    static bool on;
+    static std::string tool;
+
+    Metrics();
+
+    static std::vector<Definition>& definitions();
+    static std::vector<ThreadSlots*>& threads();
+    static ThreadSlots& local(size_t id);
+    static void reportAtExit();
+
+public:
+    static size_t define(const std::string& name, Kind kind);
+    static void enable(const std::string& toolName);
+    static bool enabled() { return on; }
+    static bool takeFlag(int& ac, char**& av, const std::string& toolName);
+
+    static double now();
+    static void addTime(size_t id, double seconds);
+    static void add(size_t id, unsigned long amount)
+    {
+        if (on)
+            local(id).values[id] += amount;
+    }
+    static void writeJson(std::ostream& out);
+};
+
+// times the enclosing scope into a TIMER metric, does nothing while the metrics are disabled
+class ScopedTimer
+{
+private:
+    size_t id;
+    double start;
+
+    ScopedTimer(const ScopedTimer& other);
+    ScopedTimer& operator=(const ScopedTimer& other);
+
+public:
+    explicit ScopedTimer(size_t id) : id(id), start(Metrics::enabled() ? Metrics::now() : -1) {}
+    ~ScopedTimer()
+    {
+        if (start >= 0)
+            Metrics::addTime(id, Metrics::now() - start);
+    }
+};
+
+#endif
@@ -1,4 +1,13 @@
 #include "BitcoinExchange.hpp"
+#include "Metrics.hpp"
+
+// hot paths reported by --metrics=json
+static const size_t LOAD_DATABASE = Metrics::define("btc.loadDatabase", Metrics::TIMER);
+static const size_t FIND_CLOSEST_DATE = Metrics::define("btc.findClosestDate", Metrics::TIMER);
+static const size_t PROCESS_INPUT_FILE = Metrics::define("btc.processInputFile", Metrics::TIMER);
+static const size_t DATABASE_ROWS = Metrics::define("btc.database_rows", Metrics::COUNTER);
+static const size_t INPUT_LINES = Metrics::define("btc.input_lines", Metrics::COUNTER);
+static const size_t INPUT_ERRORS = Metrics::define("btc.input_errors", Metrics::COUNTER);
 
 // constructor
 BitcoinExchange::BitcoinExchange(const std::string& datacsv) {
@@ -10,6 +19,7 @@ BitcoinExchange::~BitcoinExchange() {}
 
 // loads data.csv content into a map
 void BitcoinExchange::loadDatabase(const std::string& filename) {
+    ScopedTimer timer(LOAD_DATABASE);
     // open file
     std::ifstream file(filename.c_str());
     if (!file.is_open()) {
@@ -37,6 +47,7 @@ void BitcoinExchange::loadDatabase(const std::string& filename) {
                 // Store the exchange rate in the database map
                 std::string dateKey = date;
                 database[dateKey] = exchangeRate; // database["2011-01-01"] = 0.3f
+                Metrics::add(DATABASE_ROWS, 1);
             } catch (const std::exception& e) {
                 std::cerr << "Warning: Invalid conversion in database for date: " << date << std::endl;
             }
@@ -84,6 +95,7 @@ bool BitcoinExchange::isValidValue(const float value) const {
 
 // find the closest date in the database that is less than or equal to the input date
 std::string BitcoinExchange::findClosestDate(const std::string& date) const {
+    ScopedTimer timer(FIND_CLOSEST_DATE);
     std::string closestDate = ""; // starting with nothing found yet
     std::map<std::string, float>::const_iterator it;
     for (it = database.begin(); it != database.end(); ++it) {
@@ -98,6 +110,7 @@ std::string BitcoinExchange::findClosestDate(const std::string& date) const {
 
 // takes the input file and calculates the bitcoin exchange rate for every given date in the file
 void BitcoinExchange::processInputFile(const std::string& inputFile) {
+    ScopedTimer timer(PROCESS_INPUT_FILE);
     std::ifstream file(inputFile.c_str());
     if (!file.is_open()) {
         std::cout << "Error: could not open file." << std::endl;
@@ -111,6 +124,7 @@ void BitcoinExchange::processInputFile(const std::string& inputFile) {
         std::stringstream ss(line);
         std::string date;
         std::string valueStr;
+        Metrics::add(INPUT_LINES, 1);
 
         if (std::getline(ss, date, '|') && std::getline(ss, valueStr)) {
             // remove whitespace (spaces and tabs)
@@ -121,6 +135,7 @@ void BitcoinExchange::processInputFile(const std::string& inputFile) {
 
             // check that the date is valid
             if (!isValidDate(date)) {
+                Metrics::add(INPUT_ERRORS, 1);
                 std::cout << "Error: bad input, date is not valid  => " << date << std::endl;
                 continue;
             }
@@ -130,6 +145,7 @@ void BitcoinExchange::processInputFile(const std::string& inputFile) {
             try {
                 value = static_cast<float>(std::atof(valueStr.c_str()));
                 if (!isValidValue(value)) {
+                    Metrics::add(INPUT_ERRORS, 1);
                     if (value < 0)
                         std::cout << "Error: not a positive number." << std::endl;
                     else
@@ -137,6 +153,7 @@ void BitcoinExchange::processInputFile(const std::string& inputFile) {
                     continue;
                 }
             } catch (const std::exception& e) {
+                Metrics::add(INPUT_ERRORS, 1);
                 std::cout << "Error: invalid value." << std::endl;
                 continue;
             }
@@ -149,6 +166,7 @@ void BitcoinExchange::processInputFile(const std::string& inputFile) {
                 std::cout << date << " => " << value << " = " << result << std::endl;
             }
         } else {
+            Metrics::add(INPUT_ERRORS, 1);
             std::cout << "Error: bad input => " << line << std::endl;
         }
     }
@@ -1,10 +1,14 @@
 #include "BitcoinExchange.hpp"
+#include "Metrics.hpp"
 
 int main(int ac, char **av)
 {
+    // --metrics=json in front of the file writes the timers and counters to stderr at exit
+    if (!Metrics::takeFlag(ac, av, "btc"))
+        return 1;
     if (ac != 2) 
     {
-        std::cout << "Error: could not open file. Expected input: <./btc file_to_parse>" << std::endl;
+        std::cout << "Error: could not open file. Expected input: <./btc [--metrics=json] file_to_parse>" << std::endl;
         return 1;
     }
 
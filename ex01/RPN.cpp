@@ -1,7 +1,17 @@
 #include "RPN.hpp"
+#include "RPNCache.hpp"
+#include "Metrics.hpp"
+#include <cctype>
+
+// hot path reported by --metrics=json, batch workers record into their own slots
+static const size_t CALCULATE = Metrics::define("rpn.calculate", Metrics::TIMER);
+static const size_t EXPRESSION_BYTES = Metrics::define("rpn.expression_bytes", Metrics::COUNTER);
+static const size_t ERRORS = Metrics::define("rpn.errors", Metrics::COUNTER);
 
 // Constructor
-RPN::RPN() {}
+RPN::RPN()
+    : cache(NULL), minSubtreeTokens(5), windowLines(0), windowBytes(0), windowHitBytes(0), windowCount(0),
+      skipSubtrees(false), subtreeHitBytes(0) {}
 
 // Destructor
 RPN::~RPN() {}
@@ -28,15 +38,24 @@ bool RPN::isNumber(const std::string& token) const
 
 // function takes two numbers and an operator and then performs the calculation
 int RPN::performOperation(int a, int b, const std::string& op) const 
+{
+    if (!isOperator(op)) {
+        throw std::runtime_error("Error: Invalid operator");
+    }
+    return performOperation(a, b, op[0]);
+}
+
+// same calculation for a single operator character (used by the cached evaluation)
+int RPN::performOperation(int a, int b, char op) const
 {
     // Perform the specified operation on two numbers
-    if (op == "+") {
+    if (op == '+') {
         return a + b;
-    } else if (op == "-") {
+    } else if (op == '-') {
         return a - b;
-    } else if (op == "*") {
+    } else if (op == '*') {
         return a * b;
-    } else if (op == "/") {
+    } else if (op == '/') {
         // Check for division by zero
         if (b == 0) {
             throw std::runtime_error("Error: Division by zero");
@@ -75,8 +94,55 @@ void RPN::processToken(const std::string& token)
     }
 }
 
+// attach a memoization cache (or NULL to detach it), subtrees below minSubtreeTokens are not cached
+void RPN::setCache(RPNCache* newCache, size_t minTokens)
+{
+    cache = newCache;
+    minSubtreeTokens = minTokens;
+    windowLines = windowBytes = windowHitBytes = windowCount = 0;
+    skipSubtrees = false;
+}
+
+/*
+Workloads without repetition make every subtree lookup a miss, and the tree walk costs several
+times the plain evaluation. Every HIT_WINDOW lines the hit rate of the window decides about the
+next one: if less than MIN_HIT_PERCENT of the bytes were answered by the cache (whole lines,
+or the keys of subtree hits), the lines that miss the raw lookup are evaluated plainly.
+Bytes instead of lines: small subtrees repeat by chance in almost every line, but save little.
+Whole lines are still looked up and stored while skipping, so a repeated line is answered by the
+cache from its second occurrence on; every PROBE_EVERY-th window walks the trees again to notice shared subtrees.
+*/
+void RPN::countLine(size_t bytes, size_t hitBytes)
+{
+    ++windowLines;
+    windowBytes += bytes;
+    windowHitBytes += hitBytes;
+    if (windowLines < HIT_WINDOW)
+        return;
+    ++windowCount;
+    skipSubtrees = windowHitBytes * 100 < windowBytes * MIN_HIT_PERCENT && windowCount % PROBE_EVERY != 0;
+    windowLines = 0;
+    windowBytes = 0;
+    windowHitBytes = 0;
+}
+
 // function takes a complete RPN input string and processes the calculation
 int RPN::calculate(const std::string& expression) 
+{
+    ScopedTimer timer(CALCULATE);
+    Metrics::add(EXPRESSION_BYTES, expression.size());
+    try {
+        if (cache != NULL)
+            return calculateCached(expression);
+        return calculatePlain(expression);
+    } catch (const std::exception&) {
+        Metrics::add(ERRORS, 1);
+        throw;
+    }
+}
+
+// the plain stack based evaluation, token by token
+int RPN::calculatePlain(const std::string& expression)
 {
     // empty the stack for new calculation
     while (!numbers.empty()) {
@@ -95,3 +161,164 @@ int RPN::calculate(const std::string& expression)
     }
     return numbers.top(); // the token left on the stack
 }
+
+/*
+Cached evaluation:
+
+Step 1: look up the raw input line, a hit skips all work
+Step 2: build the expression tree (one node per token, in postfix order) and hash every subtree
+Step 3: walk from the root down, every subtree found in the cache is not evaluated any further
+Step 4: evaluate the remaining nodes bottom-up and store the new subtree results
+
+Example: "3 4 + 2 * 3 4 + -" -> the subtree "3 4 +" is evaluated once and found in the cache the second time
+
+Anything that does not form a valid tree (invalid tokens, missing operands, leftover numbers)
+is evaluated by calculatePlain, so the error messages stay exactly the same.
+While the line-level hit rate is low, Steps 2-4 are skipped as well (countLine).
+*/
+int RPN::calculateCached(const std::string& expression)
+{
+    unsigned long rawHash = RPNCache::hashBytes(expression.data(), expression.size());
+    const RPNCache::Result* hit = cache->find(rawHash, RPNCache::RAW_EXPRESSION, expression.data(), expression.size());
+    RPNCache::Result result;
+
+    if (hit != NULL) {
+        result = *hit;
+        countLine(expression.size(), expression.size());
+    } else {
+        subtreeHitBytes = 0;
+        try {
+            if (!skipSubtrees && buildTree(expression))
+                result.value = evaluateTree();
+            else
+                result.value = calculatePlain(expression);
+            result.ok = true;
+        } catch (const std::exception& e) {
+            result.ok = false;
+            result.value = 0;
+            result.error = e.what();
+        }
+        cache->insert(rawHash, RPNCache::RAW_EXPRESSION, expression.data(), expression.size(), result);
+        countLine(expression.size(), subtreeHitBytes);
+    }
+    if (!result.ok)
+        throw std::runtime_error(result.error);
+    return result.value;
+}
+
+// builds the tree and the normalized expression ("3  4 +" -> "3 4 +"), returns false if the expression is not a valid tree
+bool RPN::buildTree(const std::string& expression)
+{
+    nodes.clear();
+    nodeStack.clear();
+    normalized.clear();
+
+    size_t i = 0;
+    while (i < expression.size())
+    {
+        if (std::isspace(static_cast<unsigned char>(expression[i]))) {
+            ++i;
+            continue;
+        }
+        // every valid token is a single character followed by whitespace or the end
+        if (i + 1 < expression.size() && !std::isspace(static_cast<unsigned char>(expression[i + 1])))
+            return false;
+        char c = expression[i++];
+        Node node;
+        node.token = c;
+        if (c >= '0' && c <= '9') {
+            node.left = -1;
+            node.right = -1;
+            node.size = 1;
+            node.hash = RPNCache::hashLeaf(c);
+        } else if (c == '+' || c == '-' || c == '*' || c == '/') {
+            if (nodeStack.size() < 2)
+                return false;
+            node.right = nodeStack.back();
+            nodeStack.pop_back();
+            node.left = nodeStack.back();
+            nodeStack.pop_back();
+            node.size = nodes[node.left].size + nodes[node.right].size + 1;
+            node.hash = RPNCache::hashNode(c, nodes[node.left].hash, nodes[node.right].hash);
+        } else {
+            return false;
+        }
+        if (!normalized.empty())
+            normalized += ' ';
+        normalized += c;
+        nodeStack.push_back(static_cast<int>(nodes.size()));
+        nodes.push_back(node);
+    }
+    return nodeStack.size() == 1;
+}
+
+// evaluates the tree built by buildTree, cached subtrees are skipped
+int RPN::evaluateTree()
+{
+    enum { UNUSED, EVALUATE, CACHED };
+    size_t count = nodes.size();
+    int root = static_cast<int>(count) - 1; // the last token is always the root
+    int firstCachedError = -1;
+    std::string cachedError;
+
+    values.assign(count, 0);
+    state.assign(count, UNUSED);
+    state[root] = EVALUATE;
+
+    // top-down: look up every large enough subtree, only the children of misses are needed
+    for (int i = root; i >= 0; --i)
+    {
+        const Node& node = nodes[i];
+        if (state[i] != EVALUATE || node.left < 0)
+            continue;
+        if (i == root || node.size >= minSubtreeTokens) {
+            // tokens are single characters, so the subtree key is a slice of the normalized expression
+            size_t keyStart = 2 * (i + 1 - node.size);
+            const RPNCache::Result* hit = cache->find(node.hash, RPNCache::SUBTREE, normalized.data() + keyStart, 2 * node.size - 1);
+            if (hit != NULL) {
+                subtreeHitBytes += 2 * node.size - 1;
+                state[i] = CACHED;
+                values[i] = hit->value;
+                // the error of the leftmost subtree is the one the plain evaluation would throw first
+                if (!hit->ok && (firstCachedError < 0 || i < firstCachedError)) {
+                    firstCachedError = i;
+                    cachedError = hit->error;
+                }
+                continue;
+            }
+        }
+        state[node.left] = EVALUATE;
+        state[node.right] = EVALUATE;
+    }
+
+    // bottom-up in postfix order, so errors are thrown in the same order as calculatePlain would
+    for (int i = 0; i <= root; ++i)
+    {
+        const Node& node = nodes[i];
+        if (i == firstCachedError)
+            throw std::runtime_error(cachedError);
+        if (state[i] != EVALUATE)
+            continue;
+        if (node.left < 0) {
+            values[i] = node.token - '0';
+            continue;
+        }
+        RPNCache::Result result;
+        result.value = 0;
+        try {
+            result.value = performOperation(values[node.left], values[node.right], node.token);
+            result.ok = true;
+        } catch (const std::exception& e) {
+            result.ok = false;
+            result.error = e.what();
+        }
+        if (i == root || node.size >= minSubtreeTokens) {
+            size_t keyStart = 2 * (i + 1 - node.size);
+            cache->insert(node.hash, RPNCache::SUBTREE, normalized.data() + keyStart, 2 * node.size - 1, result);
+        }
+        if (!result.ok)
+            throw std::runtime_error(result.error);
+        values[i] = result.value;
+    }
+    return values[root];
+}
@@ -5,6 +5,9 @@
 #include <string> 
 #include <iostream>
 #include <sstream>
+#include <vector>
+
+class RPNCache;
 
 /*
 Why using a stack container for this exercise:
@@ -23,18 +26,59 @@ or the instruction list in the PLC area.
 class RPN 
 {
     private:
+        // node of the expression tree built for the cached evaluation, stored in postfix order
+        struct Node
+        {
+            char token;        // digit or operator
+            int left;          // index of the left operand, -1 for numbers
+            int right;         // index of the right operand, -1 for numbers
+            size_t size;       // number of tokens in this subtree
+            unsigned long hash;
+        };
+
         std::stack<int> numbers;  // stack to store numbers during calculation
-        
+        RPNCache* cache;          // optional, not owned
+        size_t minSubtreeTokens;  // smaller subtrees are cheaper to evaluate than to look up
+
+        // hit rate of the current window, decides if the next window looks up subtrees
+        size_t windowLines;
+        size_t windowBytes;       // bytes of the lines of the window
+        size_t windowHitBytes;    // bytes answered by the cache (whole lines or subtree keys)
+        size_t windowCount;
+        bool skipSubtrees;
+        size_t subtreeHitBytes;   // set by evaluateTree, key bytes of the subtrees found in the cache
+
+        static const size_t HIT_WINDOW = 512;
+        static const size_t MIN_HIT_PERCENT = 10;
+        static const size_t PROBE_EVERY = 64; // every 64th window looks up subtrees even while skipping
+
+        // buffers reused between cached calculations
+        std::string normalized;
+        std::vector<Node> nodes;
+        std::vector<int> nodeStack;
+        std::vector<int> values;
+        std::vector<char> state;
+
+        RPN(const RPN& other);
+        RPN& operator=(const RPN& other);
+
         bool isOperator(const std::string& token) const;
         bool isNumber(const std::string& token) const;
         int performOperation(int a, int b, const std::string& op) const;
+        int performOperation(int a, int b, char op) const;
         void processToken(const std::string& token);
+        int calculatePlain(const std::string& expression);
+        int calculateCached(const std::string& expression);
+        bool buildTree(const std::string& expression);
+        int evaluateTree();
+        void countLine(size_t bytes, size_t hitBytes);
 
     public:
         RPN();
         ~RPN();
 
         int calculate(const std::string& expression);
+        void setCache(RPNCache* cache, size_t minSubtreeTokens = 5);
 };
 
 #endif
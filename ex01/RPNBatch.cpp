@@ -0,0 +1,172 @@
+#include "RPNBatch.hpp"
+#include "Metrics.hpp"
+#include <time.h>
+#include <unistd.h>
+
+static const size_t BATCH_RUN = Metrics::define("rpn.batch", Metrics::TIMER);
+
+// Constructor
+RPNBatch::RPNBatch(unsigned int threads, size_t cacheBytes)
+    : numThreads(threads), activeWorkers(0), cacheBytes(cacheBytes), nextIndex(0), elapsedSeconds(0.0),
+      cacheHits(0), cacheMisses(0), cacheEvictions(0), cacheUsedBytes(0)
+{
+    if (numThreads == 0)
+        numThreads = 1;
+    pthread_mutex_init(&queueLock, NULL);
+}
+
+// Destructor
+RPNBatch::~RPNBatch()
+{
+    pthread_mutex_destroy(&queueLock);
+}
+
+// number of online cores, used when no thread count is given
+unsigned int RPNBatch::defaultThreadCount()
+{
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores < 1)
+        return 1;
+    return static_cast<unsigned int>(cores);
+}
+
+// wall clock that never jumps backwards (clock() would only measure cpu time)
+double RPNBatch::monotonicSeconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// reads one expression per line, blank lines are kept so output line i belongs to input line i
+void RPNBatch::loadExpressions(std::istream& in)
+{
+    std::string line;
+    while (std::getline(in, line))
+        expressions.push_back(line);
+}
+
+// evaluates all expressions on the worker pool and measures the elapsed time
+void RPNBatch::run()
+{
+    ScopedTimer timer(BATCH_RUN);
+    results.assign(expressions.size(), Result());
+    nextIndex = 0;
+    cacheHits = cacheMisses = cacheEvictions = cacheUsedBytes = 0;
+
+    // never start more workers than there are chunks to hand out
+    size_t numChunks = (expressions.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    unsigned int workers = numThreads;
+    if (numChunks < workers)
+        workers = numChunks > 0 ? static_cast<unsigned int>(numChunks) : 1;
+    activeWorkers = workers; // the cache budget is split between the workers that actually run
+
+    double start = monotonicSeconds();
+    std::vector<pthread_t> threads(workers - 1);
+    for (size_t i = 0; i < threads.size(); ++i)
+    {
+        if (pthread_create(&threads[i], NULL, &RPNBatch::workerEntry, this) != 0)
+        {
+            // join the workers that did start before giving up
+            for (size_t j = 0; j < i; ++j)
+                pthread_join(threads[j], NULL);
+            throw std::runtime_error("Error: could not start worker thread");
+        }
+    }
+    workerLoop(); // the calling thread works as well
+    for (size_t i = 0; i < threads.size(); ++i)
+        pthread_join(threads[i], NULL);
+    elapsedSeconds = monotonicSeconds() - start;
+}
+
+void* RPNBatch::workerEntry(void* arg)
+{
+    static_cast<RPNBatch*>(arg)->workerLoop();
+    return NULL;
+}
+
+// hands out the next chunk of line indexes, returns false when everything is claimed
+bool RPNBatch::claimChunk(size_t& begin, size_t& end)
+{
+    pthread_mutex_lock(&queueLock);
+    begin = nextIndex;
+    end = std::min(begin + CHUNK_SIZE, expressions.size());
+    nextIndex = end;
+    pthread_mutex_unlock(&queueLock);
+    return begin < end;
+}
+
+// every worker keeps one calculator for all expressions it evaluates,
+// the cache is only built with a budget
+void RPNBatch::workerLoop()
+{
+    RPN calculator;
+
+    if (cacheBytes == 0) {
+        evaluateChunks(calculator);
+        return;
+    }
+    RPNCache cache(cacheBytes / activeWorkers);
+    calculator.setCache(&cache);
+    evaluateChunks(calculator);
+
+    // add this worker's cache counters to the totals
+    pthread_mutex_lock(&queueLock);
+    cacheHits += cache.getHits();
+    cacheMisses += cache.getMisses();
+    cacheEvictions += cache.getEvictions();
+    cacheUsedBytes += cache.getUsedBytes();
+    pthread_mutex_unlock(&queueLock);
+}
+
+// evaluates chunks until all lines are claimed
+void RPNBatch::evaluateChunks(RPN& calculator)
+{
+    size_t begin, end;
+
+    while (claimChunk(begin, end))
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            Result& result = results[i]; // each index is written by exactly one worker
+            try {
+                result.value = calculator.calculate(expressions[i]);
+                result.ok = true;
+            } catch (const std::exception& e) {
+                result.ok = false;
+                result.error = e.what();
+            }
+        }
+    }
+}
+
+// prints the results in input order, returns the number of failed expressions
+size_t RPNBatch::printResults() const
+{
+    size_t failed = 0;
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        if (results[i].ok) {
+            std::cout << results[i].value << '\n'; // no flush per line, a batch can have millions of lines
+        } else {
+            std::cout.flush(); // keep errors in order with the results printed before them
+            std::cerr << results[i].error << std::endl;
+            ++failed;
+        }
+    }
+    std::cout.flush();
+    return failed;
+}
+
+void RPNBatch::printThroughput(std::ostream& out) const
+{
+    double perSecond = elapsedSeconds > 0 ? expressions.size() / elapsedSeconds : 0;
+    out << "Evaluated " << expressions.size() << " expressions with " << activeWorkers << " thread(s) in "
+        << elapsedSeconds * 1000.0 << " ms (" << static_cast<long>(perSecond) << " expressions/s)" << std::endl;
+}
+
+void RPNBatch::printCacheStats(std::ostream& out) const
+{
+    if (cacheBytes > 0)
+        RPNCache::printStats(out, cacheHits, cacheMisses, cacheEvictions, cacheUsedBytes);
+}
@@ -0,0 +1,75 @@
+#ifndef RPNBATCH_HPP
+#define RPNBATCH_HPP
+
+#include "RPN.hpp"
+#include "RPNCache.hpp"
+#include <vector>
+#include <pthread.h>
+
+/*
+Why a batch mode:
+
+Starting a new process for every expression costs far more than evaluating it.
+The batch mode reads newline-separated expressions from a file or stdin and hands
+them to a small pool of worker threads:
+
+    expressions: [e0][e1][e2][e3][e4][e5][e6][e7] ...
+                  ^ worker 1 claims a chunk, worker 2 the next one, ...
+
+- every worker owns its own RPN calculator, so the stack is reused between expressions
+- each result is stored at the index of its line, so the output keeps the input order;
+  blank lines are kept and print "Error: Invalid expression" like the single expression mode
+- workers claim chunks of lines instead of single lines to keep the lock cheap
+- with a cache budget every worker gets its own RPNCache (budget / workers), so the
+  lookups never wait for a lock, the counters are summed up when the workers are done
+*/
+
+class RPNBatch
+{
+    private:
+        // outcome of a single line, printed in the same format as the single expression mode
+        struct Result
+        {
+            bool ok;
+            int value;
+            std::string error;
+        };
+
+        std::vector<std::string> expressions;
+        std::vector<Result> results;
+        unsigned int numThreads; // requested
+        unsigned int activeWorkers; // started by the last run(), at most one per chunk
+        size_t cacheBytes; // 0 disables the cache
+        size_t nextIndex; // first expression that has not been claimed by a worker yet
+        pthread_mutex_t queueLock;
+        double elapsedSeconds;
+        size_t cacheHits;
+        size_t cacheMisses;
+        size_t cacheEvictions;
+        size_t cacheUsedBytes;
+
+        static const size_t CHUNK_SIZE = 256;
+
+        RPNBatch(const RPNBatch& other);
+        RPNBatch& operator=(const RPNBatch& other);
+
+        static void* workerEntry(void* arg);
+        void workerLoop();
+        void evaluateChunks(RPN& calculator);
+        bool claimChunk(size_t& begin, size_t& end);
+
+    public:
+        RPNBatch(unsigned int threads, size_t cacheBytes = 0);
+        ~RPNBatch();
+
+        void loadExpressions(std::istream& in);
+        void run();
+        size_t printResults() const;
+        void printThroughput(std::ostream& out) const;
+        void printCacheStats(std::ostream& out) const;
+
+        static unsigned int defaultThreadCount();
+        static double monotonicSeconds();
+};
+
+#endif
@@ -0,0 +1,256 @@
+#include "RPNBench.hpp"
+#include "RPNBatch.hpp"
+#include <cstdlib>
+
+// default workload: 200k evaluations over 2000 distinct expressions
+RPNBench::Options::Options()
+    : count(200000), distinct(2000), shape(), skew(1.1), cacheBytes(8 * 1024 * 1024), seed(42)
+{
+    shape.operands = 32;
+}
+
+// sets one benchmark option, returns false for unknown names
+bool RPNBench::parseOption(Options& options, const std::string& name, const std::string& value)
+{
+    const char* str = value.c_str();
+    if (name == "--count")
+        options.count = std::strtoul(str, NULL, 10);
+    else if (name == "--distinct")
+        options.distinct = std::strtoul(str, NULL, 10);
+    else if (name == "--operands")
+        options.shape.operands = std::strtoul(str, NULL, 10);
+    else if (name == "--depth")
+        options.shape.maxDepth = std::strtoul(str, NULL, 10);
+    else if (name == "--ops")
+        options.shape.ops = value;
+    else if (name == "--div0")
+        options.shape.divZeroRate = std::atof(str);
+    else if (name == "--invalid")
+        options.shape.invalidRate = std::atof(str);
+    else if (name == "--skew")
+        options.skew = std::atof(str);
+    else if (name == "--cache-bytes")
+        options.cacheBytes = std::strtoul(str, NULL, 10);
+    else if (name == "--seed")
+        options.seed = std::strtoul(str, NULL, 10);
+    else
+        return false;
+    return true;
+}
+
+// evaluates every workload entry, returns the elapsed seconds
+double RPNBench::evaluateAll(RPN& calculator, const std::vector<std::string>& pool,
+                             const std::vector<size_t>& workload, std::vector<RPNCache::Result>& out)
+{
+    out.assign(workload.size(), RPNCache::Result());
+    double start = RPNBatch::monotonicSeconds();
+    for (size_t i = 0; i < workload.size(); ++i)
+    {
+        try {
+            out[i].value = calculator.calculate(pool[workload[i]]);
+            out[i].ok = true;
+        } catch (const std::exception& e) {
+            out[i].ok = false;
+            out[i].error = e.what();
+        }
+    }
+    return RPNBatch::monotonicSeconds() - start;
+}
+
+/*
+Workload:
+- a pool of shared subexpressions
+- every other distinct expression combines two shared subexpressions ("A B op"),
+  so the cache can answer the large subtrees even for expressions seen the first time
+- the evaluations pick expressions with a zipf distribution
+*/
+int RPNBench::runCacheBenchmark(const Options& options)
+{
+    if (options.distinct == 0 || options.count == 0)
+        throw std::runtime_error("Error: --count and --distinct have to be positive");
+
+    static const char ops[] = "+-*/";
+    RPNGenerator generator(options.seed);
+    std::vector<std::string> shared(options.distinct / 10 + 1);
+    for (size_t i = 0; i < shared.size(); ++i)
+        shared[i] = generator.expression(options.shape.operands / 2 + 1);
+
+    std::vector<std::string> pool(options.distinct);
+    for (size_t i = 0; i < pool.size(); ++i)
+    {
+        if (i % 2 == 0)
+            pool[i] = shared[generator.uniform(shared.size())] + " " + shared[generator.uniform(shared.size())] + " " + ops[generator.uniform(4)];
+        else
+            pool[i] = generator.expression(options.shape.operands);
+    }
+    std::vector<size_t> workload = generator.zipfIndexes(options.count, options.distinct, options.skew);
+
+    // Step 1: without cache
+    RPN plain;
+    std::vector<RPNCache::Result> expected;
+    double plainSeconds = evaluateAll(plain, pool, workload, expected);
+
+    // Step 2: with cache
+    RPN cached;
+    RPNCache cache(options.cacheBytes);
+    cached.setCache(&cache);
+    std::vector<RPNCache::Result> actual;
+    double cachedSeconds = evaluateAll(cached, pool, workload, actual);
+
+    // Step 3: both runs have to agree on every value and every error
+    size_t mismatches = 0;
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        if (expected[i].ok != actual[i].ok
+            || (expected[i].ok && expected[i].value != actual[i].value)
+            || (!expected[i].ok && expected[i].error != actual[i].error))
+            ++mismatches;
+    }
+
+    // Step 4: the same number of evaluations without any repetition, the case in which the cache can only cost
+    std::vector<std::string> unique(options.count);
+    std::vector<size_t> uniqueWorkload(options.count);
+    for (size_t i = 0; i < unique.size(); ++i)
+    {
+        unique[i] = generator.expression(options.shape.operands);
+        uniqueWorkload[i] = i;
+    }
+    RPN uniquePlain;
+    std::vector<RPNCache::Result> uniqueExpected;
+    double uniquePlainSeconds = evaluateAll(uniquePlain, unique, uniqueWorkload, uniqueExpected);
+    RPN uniqueCached;
+    RPNCache uniqueCache(options.cacheBytes);
+    uniqueCached.setCache(&uniqueCache);
+    std::vector<RPNCache::Result> uniqueActual;
+    double uniqueCachedSeconds = evaluateAll(uniqueCached, unique, uniqueWorkload, uniqueActual);
+    for (size_t i = 0; i < uniqueExpected.size(); ++i)
+    {
+        if (uniqueExpected[i].ok != uniqueActual[i].ok
+            || (uniqueExpected[i].ok && uniqueExpected[i].value != uniqueActual[i].value)
+            || (!uniqueExpected[i].ok && uniqueExpected[i].error != uniqueActual[i].error))
+            ++mismatches;
+    }
+
+    std::cout << "Workload: " << options.count << " evaluations of " << options.distinct << " distinct expressions ("
+              << options.shape.operands << " operands, zipf skew " << options.skew << ")" << std::endl;
+    std::cout << "Without cache: " << plainSeconds * 1000.0 << " ms (" << static_cast<long>(options.count / plainSeconds) << " expressions/s)" << std::endl;
+    std::cout << "With cache:    " << cachedSeconds * 1000.0 << " ms (" << static_cast<long>(options.count / cachedSeconds) << " expressions/s)" << std::endl;
+    std::cout << "Speedup: " << plainSeconds / cachedSeconds << "x" << std::endl;
+    RPNCache::printStats(std::cout, cache.getHits(), cache.getMisses(), cache.getEvictions(), cache.getUsedBytes());
+    std::cout << "Non-repeating: " << options.count << " distinct expressions, without cache " << uniquePlainSeconds * 1000.0
+              << " ms, with cache " << uniqueCachedSeconds * 1000.0 << " ms, speedup " << uniquePlainSeconds / uniqueCachedSeconds
+              << "x (" << uniqueCache.getEvictions() << " evictions)" << std::endl;
+    std::cout << "Mismatches: " << mismatches << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
+
+// maps the error messages of RPN to error classes, so evaluators can be compared by class
+RPNBench::ErrorClass RPNBench::classify(const RPNCache::Result& result)
+{
+    if (result.ok)
+        return NO_ERROR;
+    if (result.error == "Error: Division by zero")
+        return DIVISION_BY_ZERO;
+    if (result.error == "Error: Not enough operands for operator")
+        return NOT_ENOUGH_OPERANDS;
+    if (result.error == "Error: Invalid token")
+        return INVALID_TOKEN;
+    if (result.error == "Error: Invalid expression")
+        return INVALID_EXPRESSION;
+    return OTHER_ERROR;
+}
+
+const char* RPNBench::errorClassName(ErrorClass errorClass)
+{
+    static const char* names[] = { "ok", "division by zero", "not enough operands", "invalid token", "invalid expression", "other error" };
+    return errorClass < ERROR_CLASS_COUNT ? names[errorClass] : "unknown";
+}
+
+void RPNBench::printThroughput(const char* name, size_t evaluations, size_t tokens, double seconds)
+{
+    std::cout << name << ": " << seconds * 1000.0 << " ms, " << static_cast<long>(evaluations / seconds) << " evaluations/s, "
+              << static_cast<long>(tokens / seconds) << " tokens/s" << std::endl;
+}
+
+/*
+Fuzz harness:
+Step 1: generate the expressions (valid ones, divisions by zero and broken ones)
+Step 2: evaluate them with the reference RPN::calculate
+Step 3: evaluate them with every candidate and compare value and error class
+*/
+int RPNBench::runFuzz(const Options& options)
+{
+    // Step 1: generate
+    RPNGenerator generator(options.seed);
+    std::vector<std::string> pool(options.count);
+    std::vector<size_t> workload(options.count);
+    size_t tokens = 0;
+    for (size_t i = 0; i < pool.size(); ++i)
+    {
+        pool[i] = generator.fuzzExpression(options.shape);
+        workload[i] = i;
+        std::stringstream ss(pool[i]);
+        std::string token;
+        while (ss >> token)
+            ++tokens;
+    }
+    std::cout << "Fuzzing " << options.count << " expressions (" << tokens << " tokens, seed " << options.seed << ")" << std::endl;
+
+    // Step 2: reference
+    RPN reference;
+    std::vector<RPNCache::Result> expected;
+    double referenceSeconds = evaluateAll(reference, pool, workload, expected);
+    printThroughput("reference RPN::calculate", pool.size(), tokens, referenceSeconds);
+
+    size_t classCounts[ERROR_CLASS_COUNT] = { 0 };
+    for (size_t i = 0; i < expected.size(); ++i)
+        ++classCounts[classify(expected[i])];
+    for (int c = 0; c < ERROR_CLASS_COUNT; ++c)
+        std::cout << "  " << errorClassName(static_cast<ErrorClass>(c)) << ": " << classCounts[c] << std::endl;
+    // --div0 is a probability per division, the share of expressions that fail with it follows from it
+    double zeroShare = generator.getDivisions() > 0 ? 100.0 * generator.getZeroDivisors() / generator.getDivisions() : 0.0;
+    std::cout << "  division by zero: " << 100.0 * classCounts[DIVISION_BY_ZERO] / pool.size() << "% of expressions, "
+              << zeroShare << "% of divisions got a 0 divisor (requested --div0 " << options.shape.divZeroRate * 100.0 << "%)" << std::endl;
+
+    // Step 3: candidates, a warm cache answers the second run from the cache
+    RPN cachedCalculator;
+    RPNCache cache(options.cacheBytes);
+    cachedCalculator.setCache(&cache);
+    struct Candidate { const char* name; RPN* calculator; };
+    Candidate candidates[] = {
+        { "cached (cold)", &cachedCalculator },
+        { "cached (warm)", &cachedCalculator }
+    };
+
+    size_t totalMismatches = 0;
+    for (size_t c = 0; c < sizeof(candidates) / sizeof(candidates[0]); ++c)
+    {
+        size_t hitsBefore = cache.getHits();
+        std::vector<RPNCache::Result> actual;
+        double seconds = evaluateAll(*candidates[c].calculator, pool, workload, actual);
+        size_t mismatches = 0;
+        for (size_t i = 0; i < actual.size(); ++i)
+        {
+            ErrorClass want = classify(expected[i]);
+            ErrorClass got = classify(actual[i]);
+            if (want == got && (want != NO_ERROR || expected[i].value == actual[i].value))
+                continue;
+            if (mismatches < 5) {
+                std::cout << "  mismatch for \"" << pool[i] << "\": expected " << errorClassName(want);
+                if (want == NO_ERROR)
+                    std::cout << " " << expected[i].value;
+                std::cout << ", got " << errorClassName(got);
+                if (got == NO_ERROR)
+                    std::cout << " " << actual[i].value;
+                std::cout << std::endl;
+            }
+            ++mismatches;
+        }
+        printThroughput(candidates[c].name, pool.size(), tokens, seconds);
+        // the warm run only hits if all lines fit into --cache-bytes, the cache is LRU
+        std::cout << "  mismatches: " << mismatches << ", speedup: " << referenceSeconds / seconds << "x, cache hits: "
+                  << cache.getHits() - hitsBefore << std::endl;
+        totalMismatches += mismatches;
+    }
+    return totalMismatches == 0 ? 0 : 1;
+}
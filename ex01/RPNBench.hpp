@@ -0,0 +1,74 @@
+#ifndef RPNBENCH_HPP
+#define RPNBENCH_HPP
+
+#include "RPN.hpp"
+#include "RPNCache.hpp"
+#include "RPNGenerator.hpp"
+
+/*
+Benchmarks for the RPN evaluator.
+
+--cache-bench: a skewed (zipf distributed) workload in which a few expressions are
+repeated very often and many expressions share large subtrees. It is evaluated once
+without and once with the memoization cache, the results have to match exactly. The same
+number of distinct, never repeated expressions is run as well and reported next to it, that
+is the cost of the cache when nothing repeats.
+
+--fuzz: random valid and broken expressions (see RPNGenerator::Shape) go through the
+reference RPN::calculate and every faster evaluator. Each candidate has to produce the
+same value, or an error of the same class, for every single expression:
+
+    expression            reference               candidate
+    "3 4 +"           ->  7                       7                        ok
+    "1 0 /"           ->  DIVISION_BY_ZERO        DIVISION_BY_ZERO         ok
+    "1 +"             ->  NOT_ENOUGH_OPERANDS     INVALID_EXPRESSION       mismatch
+
+To check a new evaluator, add it to the candidates in runFuzz.
+*/
+
+class RPNBench
+{
+    public:
+        struct Options
+        {
+            size_t count;         // number of evaluations
+            size_t distinct;      // number of distinct expressions in the workload
+            RPNGenerator::Shape shape; // operands, depth, operator mix and error rates of generated expressions
+            double skew;          // zipf exponent, higher means more repetitions
+            size_t cacheBytes;    // memory budget of the cache
+            unsigned long seed;
+
+            Options();
+        };
+
+        enum ErrorClass
+        {
+            NO_ERROR,
+            DIVISION_BY_ZERO,
+            NOT_ENOUGH_OPERANDS,
+            INVALID_TOKEN,
+            INVALID_EXPRESSION,
+            OTHER_ERROR,
+            ERROR_CLASS_COUNT
+        };
+
+    private:
+        RPNBench();
+        RPNBench(const RPNBench& other);
+        RPNBench& operator=(const RPNBench& other);
+        ~RPNBench();
+
+        static double evaluateAll(RPN& calculator, const std::vector<std::string>& pool,
+                                  const std::vector<size_t>& workload, std::vector<RPNCache::Result>& out);
+        static void printThroughput(const char* name, size_t evaluations, size_t tokens, double seconds);
+
+    public:
+        static bool parseOption(Options& options, const std::string& name, const std::string& value);
+        static int runCacheBenchmark(const Options& options);
+        static int runFuzz(const Options& options);
+
+        static ErrorClass classify(const RPNCache::Result& result);
+        static const char* errorClassName(ErrorClass errorClass);
+};
+
+#endif
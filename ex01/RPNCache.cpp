@@ -0,0 +1,180 @@
+#include "RPNCache.hpp"
+
+// Constructor
+RPNCache::RPNCache(size_t maxBytes)
+    : slots(MIN_SLOTS), slotsUsed(0), maxBytes(maxBytes), usedBytes(0), hits(0), misses(0), evictions(0) {}
+
+// Destructor
+RPNCache::~RPNCache() {}
+
+// looks up a key, a hit moves the entry to the front of the LRU list
+const RPNCache::Result* RPNCache::find(unsigned long hash, KeyKind kind, const char* key, size_t keyLength)
+{
+    size_t slot = findSlot(hash);
+    if (!slots[slot].used) {
+        ++misses;
+        return NULL;
+    }
+    Entry& entry = *slots[slot].entry;
+    // compare the stored key, equal hashes alone are not enough
+    if (entry.kind != kind || entry.key.size() != keyLength || entry.key.compare(0, keyLength, key, keyLength) != 0) {
+        ++misses;
+        return NULL;
+    }
+    ++hits;
+    entries.splice(entries.begin(), entries, slots[slot].entry); // list iterators stay valid
+    return &entries.front().result;
+}
+
+// stores a result, replaces an entry with the same hash and evicts old entries if needed
+void RPNCache::insert(unsigned long hash, KeyKind kind, const char* key, size_t keyLength, const Result& result)
+{
+    size_t bytes = sizeof(Entry) + NODE_OVERHEAD + keyLength + result.error.size();
+    if (bytes > maxBytes) // would never fit, do not flush the whole cache for it
+        return;
+
+    size_t slot = findSlot(hash);
+    if (slots[slot].used) {
+        usedBytes -= slots[slot].entry->bytes;
+        entries.erase(slots[slot].entry);
+        eraseSlot(slot);
+    }
+    // filled in place, in the node of the last evicted entry if there is one (its strings keep their buffers)
+    if (!evictUntilFits(bytes))
+        entries.push_front(Entry());
+    Entry& entry = entries.front();
+    entry.hash = hash;
+    entry.kind = kind;
+    entry.key.assign(key, keyLength);
+    entry.result = result;
+    entry.bytes = bytes;
+    addSlot(hash, entries.begin());
+    usedBytes += bytes;
+}
+
+/*
+removes least recently used entries until the new one fits into the budget;
+the last removed entry is moved to the front instead of being freed, returns true if so
+*/
+bool RPNCache::evictUntilFits(size_t incoming)
+{
+    while (!entries.empty() && usedBytes + incoming > maxBytes)
+    {
+        Entry& last = entries.back();
+        usedBytes -= last.bytes;
+        eraseSlot(findSlot(last.hash));
+        ++evictions;
+        if (usedBytes + incoming <= maxBytes) {
+            entries.splice(entries.begin(), entries, --entries.end());
+            return true;
+        }
+        entries.pop_back();
+    }
+    return false;
+}
+
+// slot that holds the hash, or the empty slot where the probe sequence for it ends
+size_t RPNCache::findSlot(unsigned long hash) const
+{
+    size_t mask = slots.size() - 1;
+    size_t i = hash & mask;
+    while (slots[i].used && slots[i].hash != hash)
+        i = (i + 1) & mask;
+    return i;
+}
+
+// empties a slot and moves later slots of the same probe sequences back, so no tombstones are needed
+void RPNCache::eraseSlot(size_t slot)
+{
+    size_t mask = slots.size() - 1;
+    size_t hole = slot;
+    slots[hole].used = false;
+    --slotsUsed;
+    for (size_t i = (hole + 1) & mask; slots[i].used; i = (i + 1) & mask)
+    {
+        size_t home = slots[i].hash & mask;
+        // the entry may move into the hole if the hole lies on its way from home to i
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            slots[hole] = slots[i];
+            slots[i].used = false;
+            hole = i;
+        }
+    }
+}
+
+// the hash must not be in the table yet, the table doubles before it gets more than half full
+void RPNCache::addSlot(unsigned long hash, EntryList::iterator entry)
+{
+    if ((slotsUsed + 1) * 2 > slots.size()) {
+        slots.assign(slots.size() * 2, Slot());
+        slotsUsed = 0;
+        for (EntryList::iterator it = entries.begin(); it != entries.end(); ++it)
+        {
+            if (it != entry)
+                addSlot(it->hash, it);
+        }
+    }
+    Slot& slot = slots[findSlot(hash)];
+    slot.used = true;
+    slot.hash = hash;
+    slot.entry = entry;
+    ++slotsUsed;
+}
+
+void RPNCache::clear()
+{
+    entries.clear();
+    slots.assign(MIN_SLOTS, Slot());
+    slotsUsed = 0;
+    usedBytes = 0;
+}
+
+size_t RPNCache::getHits() const { return hits; }
+size_t RPNCache::getMisses() const { return misses; }
+size_t RPNCache::getEvictions() const { return evictions; }
+size_t RPNCache::getUsedBytes() const { return usedBytes; }
+size_t RPNCache::getEntryCount() const { return slotsUsed; }
+
+// static so the batch mode can print the counters summed over all workers
+void RPNCache::printStats(std::ostream& out, size_t hits, size_t misses, size_t evictions, size_t usedBytes)
+{
+    size_t lookups = hits + misses;
+    double hitRate = lookups > 0 ? 100.0 * hits / lookups : 0.0;
+    out << "Cache: " << hits << " hits, " << misses << " misses, " << evictions << " evictions, "
+        << hitRate << "% hit rate, " << usedBytes << " bytes in use" << std::endl;
+}
+
+// FNV-1a over the raw bytes of an expression
+unsigned long RPNCache::hashBytes(const char* data, size_t length)
+{
+    unsigned long hash = 14695981039346656037UL;
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211UL;
+    }
+    return hash;
+}
+
+// final mixing step of splitmix64, spreads the bits of the combined subtree hashes
+static unsigned long mix(unsigned long x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9UL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebUL;
+    x ^= x >> 31;
+    return x;
+}
+
+unsigned long RPNCache::hashLeaf(char digit)
+{
+    return mix(static_cast<unsigned long>(static_cast<unsigned char>(digit)));
+}
+
+// the order of the operands matters ("1 2 -" != "2 1 -"), so left and right are mixed differently
+unsigned long RPNCache::hashNode(char op, unsigned long left, unsigned long right)
+{
+    unsigned long hash = mix(left + 0x9e3779b97f4a7c15UL);
+    hash = mix(hash ^ (right * 0xc2b2ae3d27d4eb4fUL));
+    return mix(hash ^ static_cast<unsigned char>(op));
+}
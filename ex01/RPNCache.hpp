@@ -0,0 +1,103 @@
+#ifndef RPNCACHE_HPP
+#define RPNCACHE_HPP
+
+#include <list>
+#include <vector>
+#include <string>
+#include <iostream>
+
+/*
+Why a memoization cache:
+
+Batch workloads repeat the same expressions, and often large shared subexpressions:
+
+    "8 9 * 9 - 9 - 9 - 4 - 1 + 2 *"
+    "8 9 * 9 - 9 - 9 - 4 - 1 + 3 /"
+     ^^^^^^^^^^^^^^^^^^^^^^^^^^^ same subtree, only evaluated once
+
+Two kinds of keys share one bounded cache:
+- RAW_EXPRESSION: the exact input line, a hit skips tokenizing altogether
+- SUBTREE: the whitespace-normalized tokens of a subtree (the root subtree is the whole
+  normalized expression), hashed bottom-up so every subtree gets its hash for free
+
+Entries live in a std::list ordered from most to least recently used, an open addressing
+table (linear probing, at most half full) points from the 64 bit hash into that list. The stored key is compared on every hit,
+so a hash collision can only cost a miss, never a wrong result.
+Memory is capped by maxBytes, the least recently used entries are evicted first.
+*/
+
+class RPNCache
+{
+    public:
+        enum KeyKind { RAW_EXPRESSION, SUBTREE };
+
+        // cached outcome of an evaluation, errors are cached as well
+        struct Result
+        {
+            bool ok;
+            int value;
+            std::string error;
+        };
+
+    private:
+        struct Entry
+        {
+            unsigned long hash;
+            KeyKind kind;
+            std::string key;
+            Result result;
+            size_t bytes;
+        };
+        typedef std::list<Entry> EntryList;
+        struct Slot
+        {
+            bool used;
+            unsigned long hash;
+            EntryList::iterator entry;
+        };
+
+        EntryList entries; // front = most recently used
+        std::vector<Slot> slots; // size is a power of two
+        size_t slotsUsed;
+        size_t maxBytes;
+        size_t usedBytes;
+        size_t hits;
+        size_t misses;
+        size_t evictions;
+
+        // per entry cost besides the strings: the list node (with its allocation header) and the
+        // table, which stays between a quarter and half full, so up to four slots per entry
+        static const size_t NODE_OVERHEAD = 32 + 4 * sizeof(Slot);
+        static const size_t MIN_SLOTS = 64;
+
+        RPNCache(const RPNCache& other);
+        RPNCache& operator=(const RPNCache& other);
+
+        bool evictUntilFits(size_t incoming);
+        size_t findSlot(unsigned long hash) const;
+        void eraseSlot(size_t slot);
+        void addSlot(unsigned long hash, EntryList::iterator entry);
+
+    public:
+        RPNCache(size_t maxBytes);
+        ~RPNCache();
+
+        const Result* find(unsigned long hash, KeyKind kind, const char* key, size_t keyLength);
+        void insert(unsigned long hash, KeyKind kind, const char* key, size_t keyLength, const Result& result);
+        void clear();
+
+        size_t getHits() const;
+        size_t getMisses() const;
+        size_t getEvictions() const;
+        size_t getUsedBytes() const;
+        size_t getEntryCount() const;
+
+        static void printStats(std::ostream& out, size_t hits, size_t misses, size_t evictions, size_t usedBytes);
+
+        // hashing helpers used to build the canonical keys
+        static unsigned long hashBytes(const char* data, size_t length);
+        static unsigned long hashLeaf(char digit);
+        static unsigned long hashNode(char op, unsigned long left, unsigned long right);
+};
+
+#endif
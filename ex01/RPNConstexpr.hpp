@@ -0,0 +1,163 @@
+#ifndef RPNCONSTEXPR_HPP
+#define RPNCONSTEXPR_HPP
+
+// header only, needs C++17 (built by 'make constexpr', the RPN class itself stays C++98)
+#if __cplusplus < 201703L
+# error "RPNConstexpr.hpp needs C++17, build it with 'make constexpr'"
+#endif
+
+#include <cstddef>
+#include <climits>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+/*
+Compile-time RPN evaluation:
+
+Formulas that are fixed when we build do not need a tokenizer, a std::stack and
+exceptions at runtime. The same grammar as RPN::calculate is evaluated by constexpr
+functions, so the compiler does the whole calculation:
+
+    constexpr int answer = rpn_constexpr::evaluate("8 9 * 9 - 9 - 9 - 4 - 1 +");  // 42
+    int x = RPN_CONSTANT("1 2 + 4 *");                                              // 12, no runtime cost
+
+Errors are rejected at compile time: evaluate() throws, and a throw can never be part
+of a constant expression, so "1 0 /" or "1 +" simply do not compile.
+
+tryEvaluate() reports the error class instead of throwing. It can run at compile time
+and at runtime, which is how the randomized agreement check with RPN::calculate works.
+
+Grammar (same as RPN::calculate):
+- tokens are separated by whitespace (' ', '\t', '\n', '\v', '\f', '\r')
+- numbers are single digits 0-9, operators are + - * /
+- every operator needs two operands, exactly one number has to be left at the end
+- errors are reported in token order, the first error wins
+
+Unlike the runtime class the values are checked for int overflow (Error::Overflow),
+because an overflow is undefined behaviour and is never a constant expression.
+*/
+
+namespace rpn_constexpr
+{
+    enum class Error
+    {
+        None,
+        DivisionByZero,
+        NotEnoughOperands,
+        InvalidToken,
+        InvalidExpression,
+        Overflow
+    };
+
+    struct Result
+    {
+        Error error;
+        int value;
+    };
+
+    constexpr bool isSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+    }
+
+    constexpr bool isOperator(char c)
+    {
+        return c == '+' || c == '-' || c == '*' || c == '/';
+    }
+
+    // upper bound for the number of operands on the stack
+    constexpr std::size_t maxStackDepth(std::size_t length)
+    {
+        return length / 2 + 1;
+    }
+
+    // evaluates the expression with a caller provided stack (at least maxStackDepth(expr.size()) entries)
+    constexpr Result evaluateWithStack(std::string_view expr, long long* stack)
+    {
+        std::size_t depth = 0;
+        std::size_t i = 0;
+
+        while (i < expr.size())
+        {
+            if (isSpace(expr[i])) {
+                ++i;
+                continue;
+            }
+            // the token runs until the next whitespace
+            std::size_t start = i;
+            while (i < expr.size() && !isSpace(expr[i]))
+                ++i;
+            if (i - start != 1)
+                return Result{Error::InvalidToken, 0};
+
+            char c = expr[start];
+            if (c >= '0' && c <= '9') {
+                stack[depth++] = c - '0';
+                continue;
+            }
+            if (!isOperator(c))
+                return Result{Error::InvalidToken, 0};
+            if (depth < 2)
+                return Result{Error::NotEnoughOperands, 0};
+
+            long long b = stack[--depth];
+            long long a = stack[--depth];
+            long long result = 0;
+            if (c == '+')
+                result = a + b;
+            else if (c == '-')
+                result = a - b;
+            else if (c == '*')
+                result = a * b; // both operands fit into int, so the product fits into long long
+            else {
+                if (b == 0)
+                    return Result{Error::DivisionByZero, 0};
+                result = a / b;
+            }
+            if (result < INT_MIN || result > INT_MAX)
+                return Result{Error::Overflow, 0};
+            stack[depth++] = result;
+        }
+        if (depth != 1)
+            return Result{Error::InvalidExpression, 0};
+        return Result{Error::None, static_cast<int>(stack[0])};
+    }
+
+    // stack on the (compile-time) stack frame, sized by the length of the literal
+    template <std::size_t N>
+    constexpr Result tryEvaluate(const char (&expr)[N])
+    {
+        long long stack[maxStackDepth(N)] = {};
+        return evaluateWithStack(std::string_view(expr, N - 1), stack);
+    }
+
+    constexpr const char* errorMessage(Error error)
+    {
+        switch (error)
+        {
+            case Error::None: return "";
+            case Error::DivisionByZero: return "Error: Division by zero";
+            case Error::NotEnoughOperands: return "Error: Not enough operands for operator";
+            case Error::InvalidToken: return "Error: Invalid token";
+            case Error::InvalidExpression: return "Error: Invalid expression";
+            case Error::Overflow: return "Error: Integer overflow";
+        }
+        return "Error: Unknown error";
+    }
+
+    // the value of a valid expression, any error stops the compilation when used in a constant expression
+    template <std::size_t N>
+    constexpr int evaluate(const char (&expr)[N])
+    {
+        Result result = tryEvaluate(expr);
+        if (result.error != Error::None)
+            throw std::invalid_argument(errorMessage(result.error));
+        return result.value;
+    }
+}
+
+// forces the evaluation at compile time, also outside of constexpr contexts
+#define RPN_CONSTANT(expr) (std::integral_constant<int, ::rpn_constexpr::evaluate(expr)>::value)
+
+#endif
@@ -0,0 +1,208 @@
+#include "RPNGenerator.hpp"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+// default fuzzing shape: 16 operands, all operators equally likely
+RPNGenerator::Shape::Shape() : operands(16), maxDepth(8), ops("+-*/"), divZeroRate(0.05), invalidRate(0.1) {}
+
+// Constructor, a zero state would only ever produce zeros
+RPNGenerator::RPNGenerator(unsigned long seed)
+    : rngState(seed != 0 ? seed : 0x2545f4914f6cdd1dUL), divisions(0), zeroDivisors(0) {}
+
+// Destructor
+RPNGenerator::~RPNGenerator() {}
+
+// xorshift64* step
+unsigned long RPNGenerator::next()
+{
+    rngState ^= rngState >> 12;
+    rngState ^= rngState << 25;
+    rngState ^= rngState >> 27;
+    return rngState * 0x2545f4914f6cdd1dUL;
+}
+
+// random number in [0, bound)
+size_t RPNGenerator::uniform(size_t bound)
+{
+    return bound > 0 ? next() % bound : 0;
+}
+
+// random number in [0, 1)
+double RPNGenerator::uniformReal()
+{
+    return (next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/*
+builds a valid expression with the given number of operands:
+an operator can only be placed when at least two numbers are on the stack,
+and all operands have to be used up before the remaining operators close the expression
+
+Example with 4 operands: "7 2 - 3 5 * +"
+*/
+std::string RPNGenerator::expression(size_t operands)
+{
+    static const char ops[] = "+-*/";
+    std::string expr;
+    size_t depth = 0;    // numbers currently on the stack
+    size_t remaining = operands > 0 ? operands : 1;
+
+    while (remaining > 0 || depth > 1)
+    {
+        bool pushNumber = remaining > 0 && (depth < 2 || uniform(2) == 0);
+        if (!expr.empty())
+            expr += ' ';
+        if (pushNumber) {
+            expr += static_cast<char>('0' + uniform(10));
+            --remaining;
+            ++depth;
+        } else {
+            expr += ops[uniform(4)];
+            --depth;
+        }
+    }
+    return expr;
+}
+
+// indexes in [0, distinct) where index r is drawn with a probability proportional to 1 / (r + 1)^skew
+std::vector<size_t> RPNGenerator::zipfIndexes(size_t count, size_t distinct, double skew)
+{
+    std::vector<double> cumulative(distinct);
+    double sum = 0.0;
+    for (size_t r = 0; r < distinct; ++r) {
+        sum += 1.0 / std::pow(static_cast<double>(r + 1), skew);
+        cumulative[r] = sum;
+    }
+
+    std::vector<size_t> indexes(count);
+    for (size_t i = 0; i < count; ++i) {
+        double target = uniformReal() * sum;
+        size_t r = std::upper_bound(cumulative.begin(), cumulative.end(), target) - cumulative.begin();
+        indexes[i] = std::min(r, distinct - 1);
+    }
+    return indexes;
+}
+
+// random expression following the given shape, valid unless it gets broken on purpose
+std::string RPNGenerator::fuzzExpression(const Shape& shape)
+{
+    std::string expr;
+    size_t operands = shape.operands > 0 ? shape.operands : 1;
+    size_t depth = shape.maxDepth;
+    // a tree with n leaves needs a depth of at least log2(n)
+    size_t minDepth = 0;
+    while ((static_cast<size_t>(1) << minDepth) < operands)
+        ++minDepth;
+    if (depth < minDepth)
+        depth = minDepth;
+
+    int value;
+    buildTree(expr, operands, depth, shape, false, value);
+    if (uniformReal() < shape.invalidRate)
+        breakExpression(expr);
+    return expr;
+}
+
+/*
+appends a random subtree with exactly 'operands' leaves in postfix order and stores its value
+(same int arithmetic as RPN), returns false if the subtree divides by a forced 0
+positiveLeaves: leaves 1-9 and only '+', the last resort for a divisor that must not be 0
+*/
+bool RPNGenerator::buildTree(std::string& out, size_t operands, size_t depthLeft, const Shape& shape, bool positiveLeaves, int& value)
+{
+    if (!out.empty())
+        out += ' ';
+    if (operands == 1) {
+        value = positiveLeaves ? 1 + static_cast<int>(uniform(9)) : static_cast<int>(uniform(10));
+        out += static_cast<char>('0' + value);
+        return true;
+    }
+    // split the leaves so that both sides still fit into the remaining depth
+    size_t capacity = depthLeft > 0 && depthLeft - 1 < 63 ? static_cast<size_t>(1) << (depthLeft - 1) : operands;
+    size_t minLeft = operands > capacity ? operands - capacity : 1;
+    size_t maxLeft = std::min(operands - 1, capacity);
+    size_t left = minLeft + uniform(maxLeft - minLeft + 1);
+    char op = positiveLeaves || shape.ops.empty() ? '+' : shape.ops[uniform(shape.ops.size())];
+
+    // division by zero: the divisor becomes a literal 0 if the left side can take all other leaves
+    bool zeroDivisor = op == '/' && maxLeft == operands - 1 && uniformReal() < shape.divZeroRate;
+    if (zeroDivisor)
+        left = operands - 1;
+    if (op == '/') {
+        ++divisions;
+        if (zeroDivisor)
+            ++zeroDivisors;
+    }
+
+    int a;
+    int b = 0;
+    bool valid = buildTree(out, left, depthLeft - 1, shape, positiveLeaves, a);
+    if (zeroDivisor) {
+        out += " 0";
+        valid = false;
+    } else {
+        // any other divisor is built again until it is not 0, at last with positive leaves only
+        size_t start = out.size();
+        size_t divisionsBefore = divisions;
+        for (int attempt = 0; ; ++attempt) {
+            bool last = op == '/' && attempt == NONZERO_RETRIES;
+            bool rightValid = buildTree(out, operands - left, depthLeft - 1, shape, positiveLeaves || last, b);
+            if (op != '/' || !rightValid || b != 0 || last) {
+                valid = valid && rightValid;
+                break;
+            }
+            out.erase(start);
+            divisions = divisionsBefore;
+        }
+    }
+    out += ' ';
+    out += op;
+
+    // unsigned arithmetic wraps like the int overflow of the evaluator, without being undefined
+    if (op == '+')
+        value = static_cast<int>(static_cast<unsigned int>(a) + static_cast<unsigned int>(b));
+    else if (op == '-')
+        value = static_cast<int>(static_cast<unsigned int>(a) - static_cast<unsigned int>(b));
+    else if (op == '*')
+        value = static_cast<int>(static_cast<unsigned int>(a) * static_cast<unsigned int>(b));
+    else
+        value = valid && b != 0 && !(b == -1 && a == INT_MIN) ? a / b : 0;
+    return valid;
+}
+
+size_t RPNGenerator::getDivisions() const
+{
+    return divisions;
+}
+
+size_t RPNGenerator::getZeroDivisors() const
+{
+    return zeroDivisors;
+}
+
+// breaks a valid expression in one of the ways the evaluator has to reject
+void RPNGenerator::breakExpression(std::string& expr)
+{
+    static const char* badTokens[] = { "12", "a", "%", "1.5", "(", "-3" };
+    size_t pos = uniform(expr.size() / 2 + 1) * 2; // token boundaries of a generated expression are at even positions
+
+    switch (uniform(4))
+    {
+        case 0: // invalid token somewhere in the expression
+            expr.insert(pos, std::string(badTokens[uniform(6)]) + " ");
+            break;
+        case 1: // leftover operand -> invalid expression
+            expr += " " + std::string(1, static_cast<char>('0' + uniform(10)));
+            break;
+        case 2: // extra operator -> not enough operands
+            expr += " +";
+            break;
+        default: // missing token
+            if (pos + 2 <= expr.size())
+                expr.erase(pos, 2);
+            else
+                expr.erase(pos > 0 ? pos - 1 : 0);
+            break;
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef RPNGENERATOR_HPP
+#define RPNGENERATOR_HPP
+
+#include <string>
+#include <vector>
+
+/*
+Random RPN expressions for benchmarks and the fuzz harness.
+
+The generator is deterministic for a given seed (xorshift64*), so a benchmark run
+can always be repeated with exactly the same expressions.
+
+fuzzExpression builds a random tree top-down and prints it in postfix order:
+
+            -                    operands: 4, depth <= 3
+          /   \
+         *     /                 "3 4 * 8 0 / -"
+        / \   / \
+       3   4 8   0  <- divisor forced to 0 with probability divZeroRate
+
+Every other divisor is evaluated while it is built and generated again if it comes out 0
+(leaves are 0-9 and division truncates, so that is common), so divisions by zero only
+happen where they were forced.
+A share of the expressions (invalidRate) is broken on purpose afterwards, so the
+error paths are exercised as well.
+*/
+
+class RPNGenerator
+{
+    public:
+        // controls the shape of the fuzzed expressions
+        struct Shape
+        {
+            size_t operands;      // number of numbers in a valid expression
+            size_t maxDepth;      // maximum depth of the expression tree
+            std::string ops;      // operator mix, repeating an operator makes it more likely ("++-*/")
+            double divZeroRate;   // probability that a division gets a literal 0 as divisor
+            double invalidRate;   // probability that the expression is broken on purpose
+
+            Shape();
+        };
+
+    private:
+        unsigned long rngState;
+        size_t divisions;     // divisions generated by fuzzExpression
+        size_t zeroDivisors;  // of those, the ones forced to a 0 divisor
+
+        static const int NONZERO_RETRIES = 8;
+
+        bool buildTree(std::string& out, size_t operands, size_t depthLeft, const Shape& shape, bool positiveLeaves, int& value);
+        void breakExpression(std::string& expr);
+
+    public:
+        RPNGenerator(unsigned long seed);
+        ~RPNGenerator();
+
+        unsigned long next();
+        size_t uniform(size_t bound);
+        double uniformReal();
+
+        std::string expression(size_t operands);
+        std::string fuzzExpression(const Shape& shape);
+        std::vector<size_t> zipfIndexes(size_t count, size_t distinct, double skew);
+
+        size_t getDivisions() const;
+        size_t getZeroDivisors() const;
+};
+
+#endif
@@ -1,12 +1,97 @@
 #include "RPN.hpp"
+#include "RPNBatch.hpp"
+#include "RPNBench.hpp"
+#include "Metrics.hpp"
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
+
+static void printUsage()
+{
+    std::cerr << "Usage: ./RPN [--metrics=json] \"expression\"" << std::endl;
+    std::cerr << "       ./RPN --batch [file|-] [--threads N] [--cache-bytes N]" << std::endl;
+    std::cerr << "       ./RPN --cache-bench [--count N] [--distinct N] [--operands N] [--skew S] [--cache-bytes N] [--seed N]" << std::endl;
+    std::cerr << "       ./RPN --fuzz [--count N] [--operands N] [--depth N] [--ops \"+-*/\"] [--div0 P] [--invalid P] [--seed N]" << std::endl;
+    std::cerr << "Example: ./RPN \"8 9 * 9 - 9 - 9 - 4 - 1 +\"" << std::endl;
+    std::cerr << "--metrics=json (first argument, every mode) writes timers and counters as JSON to stderr" << std::endl;
+}
+
+// evaluates one expression per line from a file or stdin on a pool of worker threads
+static int runBatch(int ac, char **av)
+{
+    std::string inputFile = "-";
+    unsigned int threads = RPNBatch::defaultThreadCount();
+    size_t cacheBytes = 0;
+
+    for (int i = 2; i < ac; ++i)
+    {
+        if (std::strcmp(av[i], "--threads") == 0 && i + 1 < ac) {
+            int value = std::atoi(av[++i]);
+            if (value < 1)
+                throw std::runtime_error("Error: --threads expects a positive number");
+            threads = static_cast<unsigned int>(value);
+        } else if (std::strcmp(av[i], "--cache-bytes") == 0 && i + 1 < ac) {
+            cacheBytes = std::strtoul(av[++i], NULL, 10);
+        } else if (av[i][0] == '-' && av[i][1] != '\0') {
+            throw std::runtime_error(std::string("Error: Unknown option ") + av[i]);
+        } else {
+            inputFile = av[i];
+        }
+    }
+
+    RPNBatch batch(threads, cacheBytes);
+    if (inputFile == "-") {
+        batch.loadExpressions(std::cin);
+    } else {
+        std::ifstream file(inputFile.c_str());
+        if (!file.is_open())
+            throw std::runtime_error("Error: could not open file " + inputFile);
+        batch.loadExpressions(file);
+    }
+    batch.run();
+    size_t failed = batch.printResults();
+    batch.printThroughput(std::cerr); // keep stdout limited to the results
+    batch.printCacheStats(std::cerr);
+    return failed == 0 ? 0 : 1;
+}
+
+// --cache-bench and --fuzz share the benchmark options
+static int runBench(int ac, char **av)
+{
+    RPNBench::Options options;
+    for (int i = 2; i < ac; ++i)
+    {
+        if (i + 1 >= ac || !RPNBench::parseOption(options, av[i], av[i + 1]))
+            throw std::runtime_error(std::string("Error: Unknown option ") + av[i]);
+        ++i;
+    }
+    if (std::strcmp(av[1], "--fuzz") == 0)
+        return RPNBench::runFuzz(options);
+    return RPNBench::runCacheBenchmark(options);
+}
 
 int main(int ac, char **av)
 {
-    if (ac != 2) 
+    if (!Metrics::takeFlag(ac, av, "RPN")) {
+        printUsage();
+        return 1;
+    }
+    if (ac >= 2 && (std::strcmp(av[1], "--batch") == 0 || std::strcmp(av[1], "--cache-bench") == 0 || std::strcmp(av[1], "--fuzz") == 0))
+    {
+        try {
+            if (std::strcmp(av[1], "--batch") == 0)
+                return runBatch(ac, av);
+            return runBench(ac, av);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            printUsage();
+            return 1;
+        }
+    }
+    if (ac != 2)
     {
         std::cerr << "Error: Expected exactly one argument" << std::endl;
-        std::cerr << "Usage: ./RPN \"expression\"" << std::endl;
-        std::cerr << "Example: ./RPN \"8 9 * 9 - 9 - 9 - 4 - 1 +\"" << std::endl;
+        printUsage();
         return 1;
     }
     try
@@ -16,8 +101,8 @@ int main(int ac, char **av)
         int result = calculator.calculate(av[1]);
         // output the result to standard output
         std::cout << result << std::endl;
-    } 
-    catch (const std::exception& e) 
+    }
+    catch (const std::exception& e)
     {
         std::cerr << e.what() << std::endl;
         return 1;
@@ -0,0 +1,95 @@
+#include "RPNConstexpr.hpp"
+#include "RPN.hpp"
+#include "RPNGenerator.hpp"
+#include <cstdlib>
+#include <vector>
+
+using rpn_constexpr::Error;
+using rpn_constexpr::tryEvaluate;
+
+// every check below runs inside the compiler, a failing one stops the build
+static_assert(rpn_constexpr::evaluate("8 9 * 9 - 9 - 9 - 4 - 1 +") == 42, "subject example");
+static_assert(rpn_constexpr::evaluate("7 7 * 7 -") == 42, "subject example");
+static_assert(rpn_constexpr::evaluate("1 2 * 2 / 2 * 2 4 - +") == 0, "subject example");
+static_assert(rpn_constexpr::evaluate(" 9\t8 -  ") == 1, "whitespace is skipped");
+static_assert(rpn_constexpr::evaluate("0 7 - 2 /") == -3, "division truncates like RPN::calculate");
+static_assert(tryEvaluate("1 0 /").error == Error::DivisionByZero, "division by zero");
+static_assert(tryEvaluate("1 +").error == Error::NotEnoughOperands, "missing operand");
+static_assert(tryEvaluate("12 3 +").error == Error::InvalidToken, "numbers are single digits");
+static_assert(tryEvaluate("(1 + 1)").error == Error::InvalidToken, "no brackets");
+static_assert(tryEvaluate("1 2").error == Error::InvalidExpression, "leftover operand");
+static_assert(tryEvaluate("").error == Error::InvalidExpression, "empty expression");
+static_assert(tryEvaluate("1 0 / x").error == Error::DivisionByZero, "the first error in token order wins");
+static_assert(tryEvaluate("9 9 * 9 * 9 * 9 * 9 * 9 * 9 * 9 * 9 * 9 *").error == Error::Overflow, "int overflow");
+
+#ifdef RPN_CONSTEXPR_SHOW_ERROR
+// 'make constexpr CONSTEXPR_FLAGS=-DRPN_CONSTEXPR_SHOW_ERROR' shows how an invalid formula is rejected
+static const int rejected = RPN_CONSTANT("4 2 2 - /");
+#endif
+
+// error class of the runtime calculator, by message
+static Error classify(const std::string& message)
+{
+    for (int e = static_cast<int>(Error::DivisionByZero); e <= static_cast<int>(Error::Overflow); ++e) {
+        if (message == rpn_constexpr::errorMessage(static_cast<Error>(e)))
+            return static_cast<Error>(e);
+    }
+    return Error::None;
+}
+
+/*
+Randomized agreement check:
+the fuzzed expressions of RPNGenerator are evaluated by RPN::calculate and by the
+constexpr evaluator (called at runtime, it is the same code the compiler runs).
+Expressions that overflow int are skipped, RPN::calculate has no defined result for them.
+*/
+static int checkAgreement(size_t count, unsigned long seed)
+{
+    RPNGenerator generator(seed);
+    RPNGenerator::Shape shape;
+    RPN calculator;
+    std::vector<long long> stack;
+    size_t mismatches = 0;
+    size_t overflows = 0;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        std::string expr = generator.fuzzExpression(shape);
+        stack.assign(rpn_constexpr::maxStackDepth(expr.size()), 0);
+        rpn_constexpr::Result compiled = rpn_constexpr::evaluateWithStack(expr, &stack[0]);
+        if (compiled.error == Error::Overflow) {
+            ++overflows;
+            continue;
+        }
+
+        Error runtimeError = Error::None;
+        int runtimeValue = 0;
+        try {
+            runtimeValue = calculator.calculate(expr);
+        } catch (const std::exception& e) {
+            runtimeError = classify(e.what());
+        }
+        if (runtimeError != compiled.error || (runtimeError == Error::None && runtimeValue != compiled.value)) {
+            if (mismatches < 5)
+                std::cout << "mismatch for \"" << expr << "\": RPN::calculate " << runtimeValue << " / "
+                          << rpn_constexpr::errorMessage(runtimeError) << ", constexpr " << compiled.value << " / "
+                          << rpn_constexpr::errorMessage(compiled.error) << std::endl;
+            ++mismatches;
+        }
+    }
+    std::cout << "Compared " << count << " random expressions (seed " << seed << "): "
+              << mismatches << " mismatches, " << overflows << " skipped because of int overflow" << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
+
+int main(int ac, char **av)
+{
+    // computed by the compiler, the binary only contains the constants
+    constexpr int subject = rpn_constexpr::evaluate("8 9 * 9 - 9 - 9 - 4 - 1 +");
+    std::cout << "8 9 * 9 - 9 - 9 - 4 - 1 + = " << subject << std::endl;
+    std::cout << "1 2 + 4 * = " << RPN_CONSTANT("1 2 + 4 *") << std::endl;
+
+    size_t count = ac > 1 ? std::strtoul(av[1], NULL, 10) : 100000;
+    unsigned long seed = ac > 2 ? std::strtoul(av[2], NULL, 10) : 42;
+    return checkAgreement(count, seed);
+}
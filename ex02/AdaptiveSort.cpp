@@ -0,0 +1,277 @@
+#include "AdaptiveSort.hpp"
+#include <cmath>
+
+// Constructor
+AdaptiveSort::AdaptiveSort() : comparisons(0), lastPath(PATH_MERGE_INSERTION), lastPieces(0) {}
+
+// Destructor
+AdaptiveSort::~AdaptiveSort() {}
+
+unsigned long AdaptiveSort::comparisonCount() const
+{
+    return comparisons + engine.counter().count();
+}
+
+void AdaptiveSort::resetCounter()
+{
+    comparisons = 0;
+    engine.resetCounter();
+}
+
+AdaptiveSort::Path AdaptiveSort::path() const
+{
+    return lastPath;
+}
+
+size_t AdaptiveSort::pieces() const
+{
+    return lastPieces;
+}
+
+const char* AdaptiveSort::pathName(Path path)
+{
+    if (path == PATH_RUNS)
+        return "natural runs";
+    if (path == PATH_FEW_UNIQUE)
+        return "few unique keys";
+    return "merge-insertion";
+}
+
+bool AdaptiveSort::less(unsigned int a, unsigned int b)
+{
+    ++comparisons;
+    return a < b;
+}
+
+void AdaptiveSort::sort(std::vector<unsigned int>& data)
+{
+    size_t n = data.size();
+    size_t numPairs = n / 2;
+    size_t descending = 0;
+
+    lastPath = PATH_MERGE_INSERTION;
+    lastPieces = 0;
+    if (n <= 1)
+        return;
+
+    // Step 1: first level of Ford-Johnson, nothing is swapped yet
+    pairDescending.assign(numPairs, false);
+    for (size_t i = 0; i < numPairs; ++i)
+    {
+        pairDescending[i] = less(data[2 * i + 1], data[2 * i]);
+        descending += pairDescending[i];
+    }
+
+    // Step 2: (almost) all pairs in one direction
+    size_t againstMajority = std::min(descending, numPairs - descending);
+    if (n >= PRESORTED_MIN && againstMajority * PRESORTED_SHARE <= numPairs
+        && probeRuns(data, descending * 2 > numPairs)) {
+        sortRuns(data);
+        return;
+    }
+
+    // Step 3: few distinct values, the second test scales the gate with n (passing it needs >= 64 pairs)
+    if (descending * 64 <= numPairs * FEW_UNIQUE_DESCENDING
+        && numPairs - 2 * descending >= FEW_UNIQUE_SIGMAS * std::sqrt(static_cast<double>(numPairs))
+        && probeFewUnique(data) && sortFewUnique(data))
+        return;
+
+    // Step 4: plain Ford-Johnson from level 2 on
+    for (size_t i = 0; i < numPairs; ++i)
+    {
+        if (pairDescending[i])
+            std::swap(data[2 * i], data[2 * i + 1]);
+    }
+    engine.sortPaired(data);
+}
+
+// compares up to RUN_PROBE evenly spaced neighbours between two pairs, true when at most
+// 1/PRESORTED_SHARE of them go against the direction of the pairs ('down': mostly descending)
+bool AdaptiveSort::probeRuns(const std::vector<unsigned int>& data, bool down)
+{
+    size_t gaps = data.size() / 2 - 1; // pair i and pair i + 1 meet at data[2i + 1], data[2i + 2]
+    size_t probes = gaps < RUN_PROBE ? gaps : RUN_PROBE;
+    size_t against = 0;
+    for (size_t j = 0; j < probes; ++j)
+    {
+        size_t i = j * gaps / probes;
+        against += less(data[2 * i + 2], data[2 * i + 1]) != down;
+    }
+    return against * PRESORTED_SHARE <= probes;
+}
+
+/*
+Splits the input into maximal runs, non-decreasing or strictly descending (reversed in place).
+The neighbours of a pair are known from step 1, every other neighbour costs one comparison.
+*/
+void AdaptiveSort::sortRuns(std::vector<unsigned int>& data)
+{
+    size_t n = data.size();
+
+    runStarts.clear();
+    size_t start = 0;
+    while (start < n)
+    {
+        size_t end = start + 1;
+        bool down = false;
+        if (end < n) {
+            down = start % 2 == 0 ? pairDescending[start / 2] : less(data[start + 1], data[start]);
+            ++end;
+            while (end < n)
+            {
+                size_t i = end - 1; // relation between data[i] and data[i + 1]
+                bool next = i % 2 == 0 ? pairDescending[i / 2] : less(data[i + 1], data[i]);
+                if (next != down)
+                    break;
+                ++end;
+            }
+        }
+        if (down)
+            std::reverse(data.begin() + start, data.begin() + end);
+        runStarts.push_back(start);
+        start = end;
+    }
+    lastPath = PATH_RUNS;
+    lastPieces = runStarts.size();
+
+    // merge neighbouring runs until one is left
+    runStarts.push_back(n);
+    while (runStarts.size() > 2)
+    {
+        size_t kept = 0;
+        for (size_t r = 0; r + 2 < runStarts.size(); r += 2)
+        {
+            mergeRuns(data, runStarts[r], runStarts[r + 1], runStarts[r + 2]);
+            runStarts[kept++] = runStarts[r];
+        }
+        if ((runStarts.size() - 1) % 2 == 1) // odd number of runs, the last one waits
+            runStarts[kept++] = runStarts[runStarts.size() - 2];
+        runStarts[kept++] = n;
+        runStarts.resize(kept);
+    }
+}
+
+/*
+first position in [start, end) whose value is greater than 'value' (afterEqual)
+or not smaller than 'value' (!afterEqual): probes start, start + 1, start + 3, ... then binary search
+*/
+size_t AdaptiveSort::gallop(unsigned int value, const std::vector<unsigned int>& data, size_t start, size_t end, bool afterEqual)
+{
+    size_t low = start;
+    size_t high = end;
+    size_t step = 1;
+
+    while (true)
+    {
+        size_t probe = start + step - 1;
+        if (probe >= end)
+            break;
+        bool past = afterEqual ? less(value, data[probe]) : !less(data[probe], value);
+        if (past) {
+            high = probe;
+            break;
+        }
+        low = probe + 1;
+        step *= 2;
+    }
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+        bool past = afterEqual ? less(value, data[mid]) : !less(data[mid], value);
+        if (past)
+            high = mid;
+        else
+            low = mid + 1;
+    }
+    return low;
+}
+
+/*
+Merges the sorted runs [first, middle) and [middle, last):
+one comparison when they are already in order, otherwise every element of the shorter run
+gallops into the longer one from where the previous element went.
+*/
+void AdaptiveSort::mergeRuns(std::vector<unsigned int>& data, size_t first, size_t middle, size_t last)
+{
+    if (!less(data[middle], data[middle - 1]))
+        return;
+
+    buffer.clear();
+    if (middle - first <= last - middle) {
+        size_t from = middle;
+        for (size_t i = first; i < middle; ++i)
+        {
+            size_t to = gallop(data[i], data, from, last, false); // equal right elements stay behind
+            buffer.insert(buffer.end(), data.begin() + from, data.begin() + to);
+            buffer.push_back(data[i]);
+            from = to;
+        }
+        buffer.insert(buffer.end(), data.begin() + from, data.begin() + last);
+    } else {
+        size_t from = first;
+        for (size_t i = middle; i < last; ++i)
+        {
+            size_t to = gallop(data[i], data, from, middle, true); // equal left elements stay in front
+            buffer.insert(buffer.end(), data.begin() + from, data.begin() + to);
+            buffer.push_back(data[i]);
+            from = to;
+        }
+        buffer.insert(buffer.end(), data.begin() + from, data.begin() + middle);
+    }
+    std::copy(buffer.begin(), buffer.end(), data.begin() + first);
+}
+
+// sorts an evenly spaced probe, true when it holds at most FEW_UNIQUE_PROBE distinct values
+bool AdaptiveSort::probeFewUnique(const std::vector<unsigned int>& data)
+{
+    size_t stride = data.size() / PROBE_SIZE;
+
+    buffer.clear();
+    for (size_t i = 0; i < PROBE_SIZE; ++i)
+        buffer.push_back(data[i * stride]);
+    engine.sort(buffer);
+
+    size_t distinct = 1;
+    for (size_t i = 1; i < buffer.size(); ++i)
+        distinct += less(buffer[i - 1], buffer[i]);
+    return distinct <= FEW_UNIQUE_PROBE;
+}
+
+// table of the distinct keys with their counts, false (input untouched) above DISTINCT_LIMIT keys
+bool AdaptiveSort::sortFewUnique(std::vector<unsigned int>& data)
+{
+    keys.clear();
+    counts.clear();
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        unsigned int value = data[i];
+        size_t low = 0;
+        size_t high = keys.size();
+        while (low < high) // first key not smaller than value
+        {
+            size_t mid = low + (high - low) / 2;
+            if (less(keys[mid], value))
+                low = mid + 1;
+            else
+                high = mid;
+        }
+        if (low < keys.size() && !less(value, keys[low])) {
+            ++counts[low];
+            continue;
+        }
+        if (keys.size() == DISTINCT_LIMIT)
+            return false;
+        keys.insert(keys.begin() + low, value);
+        counts.insert(counts.begin() + low, 1);
+    }
+
+    size_t out = 0;
+    for (size_t k = 0; k < keys.size(); ++k)
+    {
+        std::fill(data.begin() + out, data.begin() + out + counts[k], keys[k]);
+        out += counts[k];
+    }
+    lastPath = PATH_FEW_UNIQUE;
+    lastPieces = keys.size();
+    return true;
+}
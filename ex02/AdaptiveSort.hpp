@@ -0,0 +1,89 @@
+#ifndef ADAPTIVESORT_HPP
+#define ADAPTIVESORT_HPP
+
+#include <vector>
+#include <cstddef>
+#include "FordJohnson.hpp"
+
+/*
+Adaptive front end of the Ford-Johnson engine for presorted inputs and inputs with few distinct values:
+
+Step 1: the pairs (data[2i], data[2i + 1]) are compared, exactly the first level of Ford-Johnson.
+Step 2: nearly all pairs in one direction (at most 1/PRESORTED_SHARE against it, n >= PRESORTED_MIN)
+        and the same holds for an evenly spaced probe of RUN_PROBE neighbours between two pairs
+        (random values in ascending pairs pass the first test, but break a run every ~2 elements;
+        if the probe fails, step 4 follows with at most RUN_PROBE comparisons spent)
+        -> natural runs:
+        the other neighbours are compared as well (n - 1 comparisons in total), strictly descending
+        runs are reversed, the runs are merged pairwise with a galloping merge
+        (m log2(n / m) comparisons for runs of m and n elements, 1 when they are already in order)
+        -> sorted input: n - 1 comparisons (+ the probe), reversed input: the same and one reverse
+        Below PRESORTED_MIN Ford-Johnson is cheaper than n - 1 plus the merges of a few runs.
+Step 3: equal values never compare descending, so with d equally likely values only (1 - 1/d) / 2
+        of the pairs of step 1 are descending; random distinct values stay within a few sqrt(n)
+        of one half. Inputs with at most FEW_UNIQUE_DESCENDING/64 descending pairs (about 11 or fewer
+        equally likely values) that are also FEW_UNIQUE_SIGMAS standard deviations (sqrt(pairs) / 2)
+        below one half sort an evenly spaced probe. The second test scales the gate with n, random
+        values practically never pay for the probe at any size: 128 elements pass only with one value,
+        1000 with 2, 10000 with up to about 7, from ~15000 on the first test decides. With at most
+        FEW_UNIQUE_PROBE distinct values in the probe (PROBE_SIZE elements) every value is looked up
+        in a table of the distinct keys (binary search + one equality check), equal keys collapse
+        into one entry with a count
+        -> about n (log2(d) + 1) comparisons for d distinct values. More than DISTINCT_LIMIT keys
+        abandon the table (the input is left untouched).
+Step 4: otherwise the engine continues from level 2 (FordJohnson::sortPaired) with the pairs of step 1,
+        so random inputs make exactly the comparisons of the plain engine and stay within
+        maxComparisonsFJ (the probe is gated by step 3, its comparisons would not fit into the slack).
+*/
+
+class AdaptiveSort
+{
+public:
+    enum Path { PATH_MERGE_INSERTION, PATH_RUNS, PATH_FEW_UNIQUE };
+
+    static const size_t PRESORTED_SHARE = 16;
+    static const size_t PRESORTED_MIN = 32;
+    static const size_t RUN_PROBE = 64;
+    static const size_t FEW_UNIQUE_DESCENDING = 29;
+    static const size_t FEW_UNIQUE_SIGMAS = 8;
+    static const size_t PROBE_SIZE = 64;
+    static const size_t FEW_UNIQUE_PROBE = 32;
+    static const size_t DISTINCT_LIMIT = 256;
+
+private:
+    typedef FordJohnson<std::vector<unsigned int>, IdentityKey<unsigned int>, std::less<unsigned int>, ComparisonCount> Engine;
+
+    Engine engine;
+    unsigned long comparisons; // own comparisons, the engine counts its own
+    Path lastPath;
+    size_t lastPieces;
+    std::vector<bool> pairDescending;
+    std::vector<size_t> runStarts;
+    std::vector<unsigned int> buffer;
+    std::vector<unsigned int> keys;
+    std::vector<size_t> counts;
+
+    AdaptiveSort(const AdaptiveSort& other);
+    AdaptiveSort& operator=(const AdaptiveSort& other);
+
+    bool less(unsigned int a, unsigned int b);
+    bool probeRuns(const std::vector<unsigned int>& data, bool down);
+    void sortRuns(std::vector<unsigned int>& data);
+    void mergeRuns(std::vector<unsigned int>& data, size_t first, size_t middle, size_t last);
+    size_t gallop(unsigned int value, const std::vector<unsigned int>& data, size_t start, size_t end, bool afterEqual);
+    bool probeFewUnique(const std::vector<unsigned int>& data);
+    bool sortFewUnique(std::vector<unsigned int>& data);
+
+public:
+    AdaptiveSort();
+    ~AdaptiveSort();
+
+    void sort(std::vector<unsigned int>& data);
+    unsigned long comparisonCount() const;
+    void resetCounter();
+    Path path() const;
+    size_t pieces() const; // runs or distinct keys of the last sort
+    static const char* pathName(Path path);
+};
+
+#endif
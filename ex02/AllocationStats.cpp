@@ -0,0 +1,92 @@
+#include "AllocationStats.hpp"
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    size_t g_allocations = 0;
+    size_t g_currentBytes = 0;
+    size_t g_peakBytes = 0;
+    size_t g_baseBytes = 0;
+
+    // keeps the alignment malloc guarantees for the memory behind the header
+    const size_t HEADER_SIZE = 16;
+
+    void* countedAlloc(size_t size)
+    {
+        void* raw = std::malloc(size + HEADER_SIZE);
+        if (!raw)
+            throw std::bad_alloc();
+        *static_cast<size_t*>(raw) = size;
+        __sync_fetch_and_add(&g_allocations, 1);
+        size_t current = __sync_add_and_fetch(&g_currentBytes, size);
+        // raise the peak unless another thread raised it further in the meantime
+        size_t peak = g_peakBytes;
+        while (current > peak) {
+            size_t seen = __sync_val_compare_and_swap(&g_peakBytes, peak, current);
+            if (seen == peak)
+                break;
+            peak = seen;
+        }
+        return static_cast<char*>(raw) + HEADER_SIZE;
+    }
+
+    void countedFree(void* ptr)
+    {
+        if (!ptr)
+            return;
+        void* raw = static_cast<char*>(ptr) - HEADER_SIZE;
+        __sync_fetch_and_sub(&g_currentBytes, *static_cast<size_t*>(raw));
+        std::free(raw);
+    }
+}
+
+void* operator new(size_t size) throw(std::bad_alloc) { return countedAlloc(size); }
+void* operator new[](size_t size) throw(std::bad_alloc) { return countedAlloc(size); }
+void operator delete(void* ptr) throw() { countedFree(ptr); }
+void operator delete[](void* ptr) throw() { countedFree(ptr); }
+
+// the nothrow forms return NULL instead of throwing, they must not go around the counters
+void* operator new(size_t size, const std::nothrow_t&) throw()
+{
+    try {
+        return countedAlloc(size);
+    } catch (const std::bad_alloc&) {
+        return NULL;
+    }
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) throw()
+{
+    try {
+        return countedAlloc(size);
+    } catch (const std::bad_alloc&) {
+        return NULL;
+    }
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) throw() { countedFree(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) throw() { countedFree(ptr); }
+
+// starts a new measurement at the current heap level
+void AllocationStats::reset()
+{
+    g_allocations = 0;
+    g_baseBytes = g_currentBytes;
+    g_peakBytes = g_currentBytes;
+}
+
+size_t AllocationStats::allocations()
+{
+    return g_allocations;
+}
+
+size_t AllocationStats::peakBytes()
+{
+    return g_peakBytes - g_baseBytes;
+}
+
+size_t AllocationStats::currentBytes()
+{
+    return g_currentBytes;
+}
@@ -0,0 +1,35 @@
+#ifndef ALLOCATIONSTATS_HPP
+#define ALLOCATIONSTATS_HPP
+
+#include <cstddef>
+
+/*
+Heap usage of the whole program:
+
+AllocationStats.cpp replaces the global operator new/delete, the plain, array and nothrow forms.
+Every allocation gets a small header with its size, so the current and the peak number of live
+bytes are known.
+
+    AllocationStats::reset();                   // start a measurement
+    engine.sort(data);
+    AllocationStats::allocations();             // calls of operator new since reset()
+    AllocationStats::peakBytes();               // highest number of live bytes above the level at reset()
+
+The worker threads of the engine (--threads) allocate as well, so the counters are updated
+with the GCC atomic builtins (__sync_*). reset() and the getters are meant for the main
+thread between two sorts, when no worker is running.
+*/
+
+class AllocationStats
+{
+private:
+    AllocationStats();
+
+public:
+    static void reset();
+    static size_t allocations();
+    static size_t peakBytes();
+    static size_t currentBytes();
+};
+
+#endif
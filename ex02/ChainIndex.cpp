@@ -0,0 +1,192 @@
+#include "ChainIndex.hpp"
+
+// Constructor
+ChainIndex::ChainIndex() : searchLow(0), searchHigh(0), searchMid(0), root(-1), rngState(2463534242u) {}
+
+// Destructor
+ChainIndex::~ChainIndex() {}
+
+// removes all blocks, the allocated node memory is kept
+void ChainIndex::clear()
+{
+    left.clear();
+    right.clear();
+    subtreeSize.clear();
+    priority.clear();
+    blockId.clear();
+    root = -1;
+}
+
+void ChainIndex::reserve(size_t capacity)
+{
+    left.reserve(capacity);
+    right.reserve(capacity);
+    subtreeSize.reserve(capacity);
+    priority.reserve(capacity);
+    blockId.reserve(capacity);
+}
+
+size_t ChainIndex::size() const
+{
+    return sizeOf(root);
+}
+
+// xorshift32, the priorities only have to be random enough to keep the tree balanced
+unsigned int ChainIndex::nextPriority()
+{
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+size_t ChainIndex::sizeOf(int node) const
+{
+    return node < 0 ? 0 : subtreeSize[node];
+}
+
+void ChainIndex::update(int node)
+{
+    subtreeSize[node] = static_cast<unsigned int>(sizeOf(left[node]) + sizeOf(right[node]) + 1);
+}
+
+// node at the given position of the chain, -1 if rank >= size()
+int ChainIndex::nodeAt(size_t rank) const
+{
+    int node = root;
+    while (node >= 0)
+    {
+        size_t leftSize = sizeOf(left[node]);
+        if (rank < leftSize) {
+            node = left[node];
+        } else if (rank == leftSize) {
+            return node;
+        } else {
+            rank -= leftSize + 1;
+            node = right[node];
+        }
+    }
+    return -1;
+}
+
+// block number at the given position of the chain
+size_t ChainIndex::at(size_t rank) const
+{
+    int node = nodeAt(rank);
+    return node >= 0 ? blockId[node] : 0; // rank out of range, never happens for ranks < size()
+}
+
+// splits the tree into the first 'rank' blocks and the rest
+void ChainIndex::split(int node, size_t rank, int& leftPart, int& rightPart)
+{
+    if (node < 0) {
+        leftPart = rightPart = -1;
+        return;
+    }
+    size_t leftSize = sizeOf(left[node]);
+    if (rank <= leftSize) {
+        split(left[node], rank, leftPart, left[node]);
+        rightPart = node;
+    } else {
+        split(right[node], rank - leftSize - 1, right[node], rightPart);
+        leftPart = node;
+    }
+    update(node);
+}
+
+// joins two trees, every block of leftPart comes before every block of rightPart
+int ChainIndex::merge(int leftPart, int rightPart)
+{
+    if (leftPart < 0)
+        return rightPart;
+    if (rightPart < 0)
+        return leftPart;
+    if (priority[leftPart] > priority[rightPart]) {
+        right[leftPart] = merge(right[leftPart], rightPart);
+        update(leftPart);
+        return leftPart;
+    }
+    left[rightPart] = merge(leftPart, left[rightPart]);
+    update(rightPart);
+    return rightPart;
+}
+
+// puts the block at the given position, every block from that position on moves back by one
+void ChainIndex::insert(size_t rank, size_t id)
+{
+    int node = static_cast<int>(blockId.size());
+    left.push_back(-1);
+    right.push_back(-1);
+    subtreeSize.push_back(1);
+    priority.push_back(nextPriority());
+    blockId.push_back(static_cast<unsigned int>(id));
+
+    int leftPart, rightPart;
+    split(root, rank, leftPart, rightPart);
+    root = merge(merge(leftPart, node), rightPart);
+}
+
+/*
+In-order walk without recursion and without a stack (Morris traversal): before going left,
+the rightmost node of the left subtree gets a temporary right link back to the node.
+Following that link later means the left subtree is done, the link is removed again.
+A stack would grow with the depth of the tree, which is only expected to be O(log n).
+*/
+void ChainIndex::toSequence(std::vector<unsigned int>& out)
+{
+    int node = root;
+
+    out.clear();
+    out.reserve(size());
+    while (node >= 0)
+    {
+        if (left[node] < 0) {
+            out.push_back(blockId[node]);
+            node = right[node];
+            continue;
+        }
+        int last = left[node];
+        while (right[last] >= 0 && right[last] != node)
+            last = right[last];
+        if (right[last] < 0) { // first visit: link back, then walk the left subtree
+            right[last] = node;
+            node = left[node];
+        } else {               // left subtree done: remove the link
+            right[last] = -1;
+            out.push_back(blockId[node]);
+            node = right[node];
+        }
+    }
+}
+
+// starts a binary search over the first 'bound' blocks of the chain (bound <= size())
+void ChainIndex::beginSearch(size_t bound)
+{
+    searchLow = 0;
+    searchHigh = bound;
+}
+
+// block to compare next, false when the search is done
+bool ChainIndex::nextProbe(size_t& id)
+{
+    if (searchLow >= searchHigh)
+        return false;
+    searchMid = (searchLow + searchHigh) / 2;
+    id = blockId[nodeAt(searchMid)];
+    return true;
+}
+
+// result of the comparison with the last probe: true if the value goes in front of its block
+void ChainIndex::answerProbe(bool before)
+{
+    if (before)
+        searchHigh = searchMid;
+    else
+        searchLow = searchMid + 1;
+}
+
+// position for the value, in blocks
+size_t ChainIndex::searchResult() const
+{
+    return searchLow;
+}
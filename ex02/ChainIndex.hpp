@@ -0,0 +1,82 @@
+#ifndef CHAININDEX_HPP
+#define CHAININDEX_HPP
+
+#include <vector>
+#include <cstddef>
+
+/*
+Order-statistic index of the main chain (implicit treap):
+
+Inserting a pending block with std::rotate moves every element between the insertion
+point and the pending block, O(n) per insertion and O(n^2) per round. The chain index
+only stores the number of every block in chain order:
+
+    chain:  [b1][a1][a2][b3][a3] ...    ->   index: 0 1 2 4 5 ...   (block numbers)
+
+- at(rank)          block number at a position of the chain, O(log n)
+- insert(rank, id)  puts a block into the chain, O(log n), no element is moved
+- toSequence()      chain order once all blocks are inserted, O(n)
+- beginSearch(bound), nextProbe(block), answerProbe(before), searchResult():
+                    the binary search of the engine over the first 'bound' blocks, with the
+                    same probes (rank (low + high) / 2), the caller compares:
+
+                        chain.beginSearch(bound);
+                        while (chain.nextProbe(block))
+                            chain.answerProbe(value < last element of block);
+                        rank = chain.searchResult();
+
+                    Every probe is found from the root, O(log n), so a search costs O(log^2 n)
+                    steps for its O(log n) comparisons. A plain descent of the treap would need
+                    only O(log n) steps, but it compares at the treap nodes instead of the
+                    midpoints: about 1.39 log2(n) comparisons instead of ceil(log2(n + 1)),
+                    which is exactly what Ford-Johnson saves. Comparisons are the measure here.
+
+Every node knows the size of its subtree, so a position is found by walking down from
+the root. Random priorities keep the tree balanced (expected depth O(log n)).
+The nodes live in vectors and are addressed by index, so clear() keeps the memory
+for the next round. Subtree sizes and block numbers are 32 bit like the other indexes of
+the engine: 20 bytes per block.
+*/
+
+class ChainIndex
+{
+private:
+    std::vector<int> left;
+    std::vector<int> right;
+    std::vector<unsigned int> subtreeSize;
+    std::vector<unsigned int> priority;
+    std::vector<unsigned int> blockId;
+    size_t searchLow;
+    size_t searchHigh;
+    size_t searchMid;
+    int root;
+    unsigned int rngState;
+
+    ChainIndex(const ChainIndex& other);
+    ChainIndex& operator=(const ChainIndex& other);
+
+    unsigned int nextPriority();
+    size_t sizeOf(int node) const;
+    void update(int node);
+    int nodeAt(size_t rank) const;
+    void split(int node, size_t rank, int& leftPart, int& rightPart);
+    int merge(int leftPart, int rightPart);
+
+public:
+    ChainIndex();
+    ~ChainIndex();
+
+    void clear();
+    void reserve(size_t capacity);
+    size_t size() const;
+    size_t at(size_t rank) const;
+    void insert(size_t rank, size_t id);
+    void toSequence(std::vector<unsigned int>& out);
+
+    void beginSearch(size_t bound);
+    bool nextProbe(size_t& id);
+    void answerProbe(bool before);
+    size_t searchResult() const;
+};
+
+#endif
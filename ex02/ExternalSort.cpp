@@ -0,0 +1,333 @@
+#include "ExternalSort.hpp"
+#include "FordJohnson.hpp"
+#include "InputReader.hpp"
+#include "LoserTree.hpp"
+#include "PmergeMe.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <unistd.h>
+
+namespace
+{
+    const char RUN_MAGIC[8] = {'F', 'J', 'R', 'U', 'N', '0', '0', '1'};
+
+    bool isSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    std::FILE* openFile(const std::string& path, const char* mode)
+    {
+        std::FILE* file = std::fopen(path.c_str(), mode);
+        if (!file)
+            throw std::runtime_error("Error: could not open " + path + ": " + std::strerror(errno));
+        return file;
+    }
+
+    // buffered reader of one run file
+    struct RunInput
+    {
+        std::FILE* file;
+        std::vector<unsigned int> buffer;
+        size_t pos;
+        size_t size;
+        unsigned long long remaining;
+
+        RunInput() : file(NULL), pos(0), size(0), remaining(0) {}
+
+        // next element of the run, false at the end; counts the bytes it reads
+        bool next(unsigned int& value, unsigned long long& bytesRead)
+        {
+            if (pos == size)
+            {
+                if (remaining == 0)
+                    return false;
+                size_t want = remaining < buffer.size() ? static_cast<size_t>(remaining) : buffer.size();
+                size = std::fread(&buffer[0], sizeof(unsigned int), want, file);
+                if (size != want)
+                    throw std::runtime_error("Error: run file is truncated");
+                bytesRead += size * sizeof(unsigned int);
+                remaining -= size;
+                pos = 0;
+            }
+            value = buffer[pos++];
+            return true;
+        }
+    };
+
+    // appends the decimal text of value and a newline
+    void appendNumber(std::vector<char>& out, unsigned int value)
+    {
+        char digits[10];
+        int len = 0;
+        do {
+            digits[len++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value);
+        while (len > 0)
+            out.push_back(digits[--len]);
+        out.push_back('\n');
+    }
+}
+
+ExternalSort::Options::Options()
+    : runElements(1 << 20), ioBufferBytes(16 << 20), tmpDir(std::getenv("TMPDIR") ? std::getenv("TMPDIR") : "/tmp"), compare() {}
+
+ExternalSort::Stats::Stats()
+    : elements(0), runs(0), mergePasses(0), runComparisons(0), mergeComparisons(0), bytesRead(0), bytesWritten(0), seconds(0) {}
+
+// Constructor
+ExternalSort::ExternalSort(const Options& options) : options(options)
+{
+    if (this->options.runElements < 2)
+        this->options.runElements = 2;
+    if (this->options.ioBufferBytes < (1 << 16))
+        this->options.ioBufferBytes = 1 << 16;
+}
+
+// Destructor, removes the run files that are left after an error
+ExternalSort::~ExternalSort()
+{
+    for (size_t i = 0; i < runs.size(); ++i)
+        std::remove(runs[i].c_str());
+}
+
+const ExternalSort::Stats& ExternalSort::statistics() const
+{
+    return stats;
+}
+
+void ExternalSort::writeAll(std::FILE* file, const void* data, size_t bytes, const std::string& path)
+{
+    if (bytes && std::fwrite(data, 1, bytes, file) != bytes)
+        throw std::runtime_error("Error: write to " + path + " failed: " + std::strerror(errno));
+}
+
+std::string ExternalSort::newRunPath()
+{
+    std::string pattern = options.tmpDir + "/pmergeme-run-XXXXXX";
+    std::vector<char> path(pattern.begin(), pattern.end());
+    path.push_back('\0');
+    int fd = mkstemp(&path[0]);
+    if (fd < 0)
+        throw std::runtime_error("Error: could not create a run file in " + options.tmpDir + ": " + std::strerror(errno));
+    close(fd);
+    runs.push_back(&path[0]);
+    return runs.back();
+}
+
+// sorts one chunk with the Ford-Johnson engine (done by the caller) and writes it as a run
+void ExternalSort::spillRun(std::vector<unsigned int>& values)
+{
+    std::string path = newRunPath();
+    std::FILE* file = openFile(path, "wb");
+    unsigned long long count = values.size();
+
+    try {
+        writeAll(file, RUN_MAGIC, sizeof(RUN_MAGIC), path);
+        writeAll(file, &count, sizeof(count), path);
+        writeAll(file, &values[0], values.size() * sizeof(unsigned int), path);
+    } catch (...) {
+        std::fclose(file);
+        throw;
+    }
+    if (std::fclose(file) != 0)
+        throw std::runtime_error("Error: write to " + path + " failed");
+    stats.bytesWritten += sizeof(RUN_MAGIC) + sizeof(count) + values.size() * sizeof(unsigned int);
+    ++stats.runs;
+    values.clear();
+}
+
+/*
+Phase 1: stream the text input in chunks of ioBufferBytes, a token cut at the end of a chunk
+is carried over to the next one. Every runElements numbers are sorted and spilled.
+*/
+void ExternalSort::formRuns(const std::string& inputPath)
+{
+    FordJohnson<std::vector<unsigned int>, IdentityKey<unsigned int>, CostlyLess, ComparisonCount>
+        engine(IdentityKey<unsigned int>(), options.compare);
+    std::vector<unsigned int> values;
+    std::vector<char> chunk(options.ioBufferBytes);
+    size_t carried = 0;
+    std::FILE* input = openFile(inputPath, "rb");
+
+    values.reserve(options.runElements);
+    try {
+        while (true)
+        {
+            size_t got = std::fread(&chunk[carried], 1, chunk.size() - carried, input);
+            stats.bytesRead += got;
+            bool atEnd = got == 0;
+            size_t size = carried + got;
+
+            // the last token may continue in the next chunk
+            size_t parseEnd = size;
+            if (!atEnd) {
+                while (parseEnd > 0 && !isSpace(chunk[parseEnd - 1]))
+                    --parseEnd;
+                if (parseEnd == 0 && size == chunk.size())
+                    throw std::runtime_error("Please provide valid numeric positive arguments.");
+            }
+
+            const char* pos = &chunk[0];
+            const char* end = &chunk[0] + parseEnd;
+            while (pos < end)
+            {
+                if (isSpace(*pos)) {
+                    ++pos;
+                    continue;
+                }
+                unsigned int value;
+                if (!InputReader::parseToken(pos, end, value) || (pos < end && !isSpace(*pos)))
+                    throw std::runtime_error("Please provide valid numeric positive arguments.");
+                values.push_back(value);
+                ++stats.elements;
+                if (values.size() == options.runElements) {
+                    engine.sort(values);
+                    spillRun(values);
+                }
+            }
+            if (atEnd)
+                break;
+            carried = size - parseEnd;
+            std::memmove(&chunk[0], &chunk[parseEnd], carried);
+        }
+        if (!values.empty()) {
+            engine.sort(values);
+            spillRun(values);
+        }
+    } catch (...) {
+        std::fclose(input);
+        throw;
+    }
+    std::fclose(input);
+    stats.runComparisons = engine.counter().count();
+}
+
+/*
+Phase 2: merges runs[first, last) with a loser tree.
+An empty outputPath writes a new run (intermediate pass), otherwise the text output.
+The merged runs are removed.
+*/
+std::string ExternalSort::mergeRuns(size_t first, size_t last, const std::string& outputPath)
+{
+    size_t k = last - first;
+    std::vector<RunInput> inputs(k);
+    size_t perRun = std::max<size_t>(options.ioBufferBytes / (k + 1) / sizeof(unsigned int), 1024);
+    LoserTree tree(k, options.compare);
+    std::vector<std::string> merged(runs.begin() + first, runs.begin() + last);
+
+    // output buffer: a new run file or the text output
+    bool intermediate = outputPath.empty();
+    std::string path = intermediate ? newRunPath() : outputPath;
+    std::FILE* output = openFile(path, "wb");
+    std::vector<char> text;
+    std::vector<unsigned int> binary;
+    unsigned long long count = 0;
+
+    try {
+        for (size_t r = 0; r < k; ++r)
+        {
+            char magic[sizeof(RUN_MAGIC)];
+            inputs[r].file = openFile(merged[r], "rb");
+            if (std::fread(magic, 1, sizeof(magic), inputs[r].file) != sizeof(magic)
+                || std::memcmp(magic, RUN_MAGIC, sizeof(magic)) != 0
+                || std::fread(&inputs[r].remaining, sizeof(inputs[r].remaining), 1, inputs[r].file) != 1)
+                throw std::runtime_error("Error: " + merged[r] + " is not a run file");
+            stats.bytesRead += sizeof(magic) + sizeof(inputs[r].remaining);
+            count += inputs[r].remaining;
+            inputs[r].buffer.resize(perRun);
+
+            unsigned int head;
+            if (inputs[r].next(head, stats.bytesRead))
+                tree.setHead(r, head);
+        }
+        tree.build();
+
+        if (intermediate) {
+            writeAll(output, RUN_MAGIC, sizeof(RUN_MAGIC), path);
+            writeAll(output, &count, sizeof(count), path);
+            stats.bytesWritten += sizeof(RUN_MAGIC) + sizeof(count);
+            binary.reserve(perRun);
+        } else {
+            text.reserve(perRun * sizeof(unsigned int) + 16);
+        }
+
+        while (!tree.empty())
+        {
+            unsigned int value = tree.top();
+            if (intermediate)
+                binary.push_back(value);
+            else
+                appendNumber(text, value);
+
+            unsigned int next;
+            if (inputs[tree.winner()].next(next, stats.bytesRead))
+                tree.replaceTop(next);
+            else
+                tree.popTop();
+
+            // flush in large blocks
+            if (binary.size() == perRun || text.size() + 11 > perRun * sizeof(unsigned int)) {
+                writeAll(output, binary.empty() ? static_cast<const void*>(&text[0]) : &binary[0],
+                         binary.empty() ? text.size() : binary.size() * sizeof(unsigned int), path);
+                stats.bytesWritten += binary.empty() ? text.size() : binary.size() * sizeof(unsigned int);
+                binary.clear();
+                text.clear();
+            }
+        }
+        if (!binary.empty() || !text.empty()) {
+            size_t bytes = binary.empty() ? text.size() : binary.size() * sizeof(unsigned int);
+            writeAll(output, binary.empty() ? static_cast<const void*>(&text[0]) : &binary[0], bytes, path);
+            stats.bytesWritten += bytes;
+        }
+    } catch (...) {
+        for (size_t r = 0; r < k; ++r)
+            if (inputs[r].file)
+                std::fclose(inputs[r].file);
+        std::fclose(output);
+        throw;
+    }
+    for (size_t r = 0; r < k; ++r)
+        std::fclose(inputs[r].file);
+    if (std::fclose(output) != 0)
+        throw std::runtime_error("Error: write to " + path + " failed");
+
+    for (size_t r = 0; r < k; ++r)
+        std::remove(merged[r].c_str());
+    stats.mergeComparisons += tree.comparisonCount();
+    ++stats.mergePasses;
+    return path;
+}
+
+void ExternalSort::sort(const std::string& inputPath, const std::string& outputPath)
+{
+    double start = PmergeMe::monotonicSeconds();
+
+    formRuns(inputPath);
+    // merge the oldest MAX_FAN_IN runs into a new run until one final merge is enough
+    size_t head = 0;
+    while (runs.size() - head > MAX_FAN_IN) {
+        mergeRuns(head, head + MAX_FAN_IN, "");
+        head += MAX_FAN_IN;
+    }
+    mergeRuns(head, runs.size(), outputPath);
+    runs.clear();
+    stats.seconds = PmergeMe::monotonicSeconds() - start;
+}
+
+void ExternalSort::report(std::ostream& out) const
+{
+    double seconds = stats.seconds > 0 ? stats.seconds : 1e-9;
+    out << "Sorted " << stats.elements << " elements in " << stats.runs << " runs of up to "
+        << options.runElements << " elements, " << stats.mergePasses << " merge(s)" << std::endl;
+    out << "Comparisons: " << stats.runComparisons + stats.mergeComparisons << " (runs " << stats.runComparisons
+        << ", merge " << stats.mergeComparisons << "), theoretical limit of one Ford-Johnson sort: "
+        << PmergeMe::maxComparisonsFJ(stats.elements) << std::endl;
+    out << "I/O: " << stats.bytesRead << " bytes read, " << stats.bytesWritten << " bytes written" << std::endl;
+    out << "Time: " << seconds << " s, " << stats.elements / seconds / 1e6 << " M elements/s, "
+        << (stats.bytesRead + stats.bytesWritten) / seconds / 1e6 << " MB/s of I/O" << std::endl;
+}
@@ -0,0 +1,82 @@
+#ifndef EXTERNALSORT_HPP
+#define EXTERNALSORT_HPP
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstddef>
+#include <ostream>
+#include "SortPlanner.hpp"
+
+/*
+Out-of-core merge-insertion sort for inputs larger than RAM:
+
+Phase 1 (run formation): the text input is streamed in chunks, every runElements numbers are
+sorted with the Ford-Johnson engine and spilled to a temporary run file.
+Phase 2 (merge): up to MAX_FAN_IN runs at a time are merged with a LoserTree (log2(k)
+comparisons per element). More runs than that are merged in several passes, the last pass
+writes the output as text, one number per line.
+
+Run file format (binary, native byte order, the runs never leave the machine):
+    "FJRUN001"  8 bytes magic
+    count       uint64, number of elements
+    elements    count * uint32
+
+All file access goes through large buffers (ioBufferBytes, split between the open runs of a
+merge), so the disks only see big sequential reads and writes. The input has the same rules
+as argv (InputReader::parseToken). Run files are removed as soon as they are merged.
+*/
+
+class ExternalSort
+{
+public:
+    struct Options
+    {
+        size_t runElements;   // numbers per sorted run (memory budget)
+        size_t ioBufferBytes; // total buffer of a merge pass
+        std::string tmpDir;
+        CostlyLess compare;
+
+        Options();
+    };
+
+    struct Stats
+    {
+        unsigned long elements;
+        unsigned long runs;
+        unsigned long mergePasses;
+        unsigned long runComparisons;
+        unsigned long mergeComparisons;
+        unsigned long long bytesRead;
+        unsigned long long bytesWritten;
+        double seconds;
+
+        Stats();
+    };
+
+private:
+    static const size_t MAX_FAN_IN = 64;
+
+    Options options;
+    Stats stats;
+    std::vector<std::string> runs;
+
+    ExternalSort(const ExternalSort& other);
+    ExternalSort& operator=(const ExternalSort& other);
+
+    void formRuns(const std::string& inputPath);
+    void spillRun(std::vector<unsigned int>& values);
+    std::string mergeRuns(size_t first, size_t last, const std::string& outputPath);
+    std::string newRunPath();
+    static void writeAll(std::FILE* file, const void* data, size_t bytes, const std::string& path);
+
+public:
+    explicit ExternalSort(const Options& options);
+    ~ExternalSort();
+
+    void sort(const std::string& inputPath, const std::string& outputPath);
+    const Stats& statistics() const;
+    void report(std::ostream& out) const;
+};
+
+#endif
@@ -0,0 +1,160 @@
+#include "FordJohnson.hpp"
+
+// Constructor
+FordJohnsonBase::FordJohnsonBase() {}
+
+// Destructor
+FordJohnsonBase::~FordJohnsonBase() {}
+
+// Jacobsthal numbers, computed by the compiler (SmallSort.hpp)
+const unsigned int FordJohnsonBase::JACOBSTHAL[JACOBSTHAL_COUNT] = {
+    Jacobsthal<0>::value,  Jacobsthal<1>::value,  Jacobsthal<2>::value,  Jacobsthal<3>::value,
+    Jacobsthal<4>::value,  Jacobsthal<5>::value,  Jacobsthal<6>::value,  Jacobsthal<7>::value,
+    Jacobsthal<8>::value,  Jacobsthal<9>::value,  Jacobsthal<10>::value, Jacobsthal<11>::value,
+    Jacobsthal<12>::value, Jacobsthal<13>::value, Jacobsthal<14>::value, Jacobsthal<15>::value,
+    Jacobsthal<16>::value, Jacobsthal<17>::value, Jacobsthal<18>::value, Jacobsthal<19>::value,
+    Jacobsthal<20>::value, Jacobsthal<21>::value, Jacobsthal<22>::value, Jacobsthal<23>::value,
+    Jacobsthal<24>::value, Jacobsthal<25>::value, Jacobsthal<26>::value, Jacobsthal<27>::value,
+    Jacobsthal<28>::value, Jacobsthal<29>::value, Jacobsthal<30>::value, Jacobsthal<31>::value,
+    Jacobsthal<32>::value, Jacobsthal<33>::value
+};
+
+// calculate the Jacobsthal sequence
+/*
+Example calculation to show how this works:
+
+Sequence: 11 2 17 0 16 8 6 15 10 3 21 1 18 9 14 19 12 5 4 20 13 -> 21 elements
+maxPending = 21 / 2 + 1 = 10 + 1 = 11
+
+Calculate Jacobsthal sequence:
+J(0) = 0
+J(1) = 1
+J(2) = J(1) + 2*J(0) = 1 + 2*0 = 1
+J(3) = J(2) + 2*J(1) = 1 + 2*1 = 3
+J(4) = J(3) + 2*J(2) = 3 + 2*1 = 5
+J(5) = J(4) + 2*J(3) = 5 + 2*3 = 11
+J(6) = J(5) + 2*J(4) = 11 + 2*5 = 21
+
+Original: [0, 1, 1, 3, 5, 11, 21]
+After removing duplicates: [0, 1, 3, 5, 11, 21]
+
+Filter for values ≤ maxPending (11) -> JT never higher than maxPending!
+
+Collect Jacobsthal numbers > 0 and ≤ 11: [1, 3, 5, 11]
+Build insertion order:
+J=1 → [1]
+J=3 → [1, 3, 2] (fill gap between 1 and 3)
+J=5 → [1, 3, 2, 5, 4] (fill gap between 3 and 5)  
+J=11 → [1, 3, 2, 5, 4, 11, 10, 9, 8, 7, 6] (fill gap between 5 and 11)
+*/
+std::vector<unsigned int> FordJohnsonBase::getJacobsthalIndexes(unsigned int n) 
+{
+    std::vector<unsigned int> jacobsthal;
+    jacobsthal.reserve(JACOBSTHAL_COUNT); // one allocation, whatever n is
+    if (n > 0)
+        jacobsthal.push_back(JACOBSTHAL[0]);
+    // take JT from the table until we reach n (n == max_pending elements)
+    for (size_t k = 1; k < JACOBSTHAL_COUNT; ++k)
+    {
+        if (k == 2) // skip the duplicate '1' (J(1)=1 and J(2)=1)
+            continue;
+        jacobsthal.push_back(JACOBSTHAL[k]);
+        if (JACOBSTHAL[k] >= n)
+            break;
+    }
+    return jacobsthal;
+}
+
+// calculate how many elements need to be inserted for the Ford Johnson algorithm
+/*
+Calculation example:
+
+Sequence: 11 2 17 0 16 8 6 15 10 3 21 1 18 9 14 19 12 5 4 20 13
+blockSize = 1u << (4 - 1) = 8
+numBlocks = 21 / 8 = 2
+numPending = getNumPending(2)
+
+numPending = (2 / 2) = 1        // 2 blocks → 1 pair → 1 pending
+if (2 % 2 != 0) → false         // No leftover block
+Result: 1 pending element
+
+blockSize = 1u << (3 - 1) = 4
+numBlocks = 21 / 4 = 5
+numPending = getNumPending(5)
+
+numPending = (5 / 2) = 2        // 5 blocks → 2 pairs → 2 pending
+if (5 % 2 != 0) → true          // Odd number of blocks
+    ++numPending                // +1 for leftover block
+Result: 2 + 1 = 3 pending elements
+
+and so on ...
+*/
+size_t FordJohnsonBase::getNumPending(size_t numBlocks) 
+{
+    size_t numPending = (numBlocks / 2); // each pair contributes one 'b'
+    if (numBlocks % 2 != 0) // if odd number of blocks, leftover 'b' also pending
+        ++numPending;
+    return numPending;
+}
+
+/*
+Example:
+Input: numPending = 6; JTseq = [0, 1, 1, 3, 5, 11, 21]
+Collect valid JT numbers <= numPending: jacobsthalNumbers = [1, 1, 3, 5]
+Build insertion order: insertionOrder = [1, 1, 3, 2, 5, 4, 6]
+*/
+void FordJohnsonBase::buildInsertOrder(size_t numPending, const std::vector<unsigned int>& JTseq, std::vector<unsigned int>& insertionOrder)
+{
+    insertionOrder.clear(); // keeps the capacity, the buffer is reused by every round
+    if (numPending == 0 || JTseq.empty())
+        return;
+
+    // Build insertion order following Ford-Johnson pattern, using the Jacobsthal numbers > 0 and <= numPending
+    // Pattern: J1, J1-1, J2, J2-1, J2-2, ..., J3, J3-1, ..., remaining in reverse
+    unsigned int prev = 0;
+    for (std::vector<unsigned int>::const_iterator it = JTseq.begin(); it != JTseq.end(); ++it) {
+        unsigned int j = *it;
+        if (j == 0 || j > static_cast<unsigned int>(numPending))
+            continue;
+
+        // Add the Jacobsthal number itself
+        insertionOrder.push_back(j);
+        
+        // Fill gaps in descending order from j-1 down to prev+1
+        for (unsigned int k = j - 1; k > prev; --k) {
+            insertionOrder.push_back(k);
+        }
+        prev = j;
+    }
+
+    // Add remaining elements in descending order
+    // These are elements > the last Jacobsthal number
+    for (size_t i = numPending; i > prev; --i) {
+        insertionOrder.push_back(static_cast<unsigned int>(i));
+    }
+}
+
+// finds the index k in the Jacobsthal sequence where JTseq[k] >= pendIndex
+// determine which group of pending elements is currently being processed
+size_t FordJohnsonBase::computeK(unsigned int pendIndex, const std::vector<unsigned int>& JTseq) 
+{
+    for (unsigned int k = 0; k < JTseq.size(); ++k)
+    {
+        if (pendIndex <= JTseq[k])
+            return k;
+    }
+    // if pendIndex is larger than all JTseq values, return the last index
+    return JTseq.size();
+}
+
+// calculate maximum number of blocks in the main chain there are relevant for inserting the pending element
+size_t FordJohnsonBase::computeUsefulMainEnd(size_t k, size_t pendingPos, size_t blockSize) 
+{
+    size_t usefulEnd = (static_cast<size_t>(1) << k) - 1; // 2^k - 1 blocks allowed according to FJ
+    size_t availableBlocks = pendingPos / blockSize; // blocks in main chain
+
+    if (usefulEnd > availableBlocks)
+        usefulEnd = availableBlocks;
+
+    return usefulEnd;
+}
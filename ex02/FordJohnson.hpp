@@ -0,0 +1,322 @@
+#ifndef FORDJOHNSON_HPP
+#define FORDJOHNSON_HPP
+
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <cstddef>
+#include <pthread.h>
+#include "ChainIndex.hpp"
+#include "SmallSort.hpp"
+
+/*
+One merge-insertion (Ford-Johnson) engine for every container:
+
+The algorithm used to be written twice, once for std::vector and once for std::deque,
+and both copies could only sort unsigned int with operator<. The engine is a template:
+
+    FordJohnson<Container, KeyOf, Compare, Counter, Probe>
+
+- Container: any random access container (std::vector, std::deque, ...)
+- KeyOf:     extracts the key of a record, IdentityKey uses the value itself
+- Compare:   strict weak ordering on the keys, std::less by default
+- Counter:   compile-time comparison counting policy
+             NoComparisonCount -> tick() is an empty inline function, costs nothing
+             ComparisonCount   -> counts every call of the comparator
+- Probe:     compile-time phase probe, begin(phase) / end(phase) around the phases
+             pairing, restructuring (sortMainPendb2b, gather) and insertion
+             NoPhaseProbe   -> empty inline functions, costs nothing
+             PerfPhaseProbe -> hardware counters per phase (PerfCounters.hpp)
+             MetricsPhaseProbe -> wall time per phase for --metrics=json (MetricsPhaseProbe.hpp)
+
+Insertion backends (same comparisons, different data movement):
+- ROTATE_INSERT:  every pending block is moved into the chain with fjMoveBlock (std::rotate),
+                  O(n) moves per insertion -> quadratic time on large inputs
+                  (a TieredVector moves it in O(sqrt(n)))
+- INDEXED_INSERT: the chain is tracked as block numbers in a ChainIndex (order-statistic tree),
+                  the binary search reads the blocks through the index and every element is
+                  moved exactly once per round -> O(n) moves per round, O(n log n) in total;
+                  the index work is O(log n) per probe, O(n log^2 n) in total (ChainIndex.hpp)
+- AUTO_INSERT:    rotate for small inputs and rounds with few blocks, indexed for the large ones
+
+Small levels (setSmallSortCutoff(n), default SMALL_SORT_MAX = 16):
+the pairing stops at the first level with at most n blocks, those blocks are sorted by their last
+element with one unrolled kernel (SmallSort.hpp) instead of the remaining pairing levels and
+insertion rounds. Same worst case, but no round bookkeeping; inputs of up to n elements are sorted
+by the kernel alone. A cutoff of 0 or 1 runs every level through the rounds.
+
+Fixed block sizes (setFixedBlocks(false) turns them off):
+the levels with blocks of 1, 2, 4, 8 and 16 elements swap, restructure, gather and rotate their
+blocks with the block size as a template parameter (FjBlock<N>), larger blocks use the run time size.
+With a constant length every block copy of a std::vector becomes a few (vector) loads and stores
+instead of a loop or a memmove call, and the rotate backend moves a block with one save / shift /
+store instead of the cycles of std::rotate. The comparisons are the same.
+
+Key widths: the engine is instantiated for the records it sorts, e.g. for 32-bit and 64-bit keys
+(unsigned int, unsigned long long) and for key + payload packed into one 64-bit word:
+
+    FordJohnson<std::vector<unsigned long long>, PackedKey<unsigned long long, 32> > engine;
+
+Memory: the engine owns one scratch arena of n elements, sized once per sort. Every round
+restructures the blocks into the arena and hands the result back to the container:
+a std::vector swaps buffers with the arena (no copy), other containers get the elements copied back.
+The insertion order, the chain index and its output, the Jacobsthal table and the thread tasks are
+sized once per sort as well, so the number of allocations per sort does not depend on n
+(AllocationStats, printed by ./PmergeMe).
+
+Threads (setThreads(n), default 1):
+- pairing: the pairs of one level are disjoint, every thread compares and swaps a range of pairs
+  with its own counter, the counters are merged after the join
+- indexed insertion: the final gather of the blocks in chain order is split between the threads
+- the binary searches stay sequential: inside a Jacobsthal group a search can land between blocks
+  inserted earlier in the same group, so searching them in parallel would change the comparisons
+Small levels (< PARALLEL_MIN_ELEMENTS elements) are not worth starting threads and run sequentially.
+
+Ford-Johnson minimizes the number of comparisons, so it pays off for records whose keys
+are expensive to compare, e.g. sorting structs by a string member:
+
+    struct ByName { typedef std::string key_type; const std::string& operator()(const Person& p) const { return p.name; } };
+    FordJohnson<std::vector<Person>, ByName> engine;
+    engine.sort(people);
+*/
+
+// uses the value itself as the key
+template <typename T>
+struct IdentityKey
+{
+    typedef T key_type;
+    const T& operator()(const T& value) const { return value; }
+};
+
+/*
+Key + payload packed into one word: the key is the upper bits, the lower PAYLOAD_BITS bits carry
+the payload (e.g. the index of a record) and take no part in the comparisons.
+*/
+template <typename Word, unsigned int PAYLOAD_BITS>
+struct PackedKey
+{
+    typedef Word key_type;
+    Word operator()(const Word& record) const { return record >> PAYLOAD_BITS; }
+};
+
+// comparison counting disabled
+struct NoComparisonCount
+{
+    void tick() {}
+    void merge(const NoComparisonCount&) {}
+    unsigned long count() const { return 0; }
+};
+
+// comparison counting enabled
+struct ComparisonCount
+{
+    unsigned long comparisons;
+
+    ComparisonCount() : comparisons(0) {}
+    void tick() { ++comparisons; }
+    void merge(const ComparisonCount& other) { comparisons += other.comparisons; }
+    unsigned long count() const { return comparisons; }
+};
+
+// hands a restructured sequence back to the container, the old buffer becomes the next scratch arena
+template <typename T>
+void fjAdoptScratch(std::vector<T>& data, std::vector<T>& scratch)
+{
+    data.swap(scratch);
+}
+
+template <typename Container, typename T>
+void fjAdoptScratch(Container& data, std::vector<T>& scratch)
+{
+    std::copy(scratch.begin(), scratch.end(), data.begin());
+}
+
+// moves the pending block [start, end) to insertPos in front of it (rotate backend),
+// containers with a cheaper middle insert overload it (TieredVector.hpp)
+template <typename Container>
+void fjMoveBlock(Container& data, size_t insertPos, size_t start, size_t end)
+{
+    std::rotate(data.begin() + insertPos, data.begin() + start, data.begin() + end);
+}
+
+// size of a block known at compile time (N), or only at run time (N = 0)
+template <size_t N>
+struct FjBlock
+{
+    static size_t size(size_t) { return N; }
+};
+
+template <>
+struct FjBlock<0>
+{
+    static size_t size(size_t blockSize) { return blockSize; }
+};
+
+// same move for a block of N elements: the block is saved, the elements in between move up by N,
+// the block goes in front (TieredVector.hpp overloads it as well)
+template <size_t N, typename Container>
+void fjMoveFixedBlock(Container& data, size_t insertPos, size_t start)
+{
+    typename Container::value_type block[N];
+    std::copy(data.begin() + start, data.begin() + start + N, block);
+    std::copy_backward(data.begin() + insertPos, data.begin() + start, data.begin() + start + N);
+    std::copy(block, block + N, data.begin() + insertPos);
+}
+
+// phase probing disabled
+struct NoPhaseProbe
+{
+    void begin(int) {}
+    void end(int) {}
+};
+
+// bookkeeping of the algorithm that does not depend on the element type
+class FordJohnsonBase
+{
+public:
+    enum InsertBackend { ROTATE_INSERT, INDEXED_INSERT, AUTO_INSERT };
+
+    // AUTO_INSERT switches to the index from this number of blocks per round on
+    static const size_t INDEXED_MIN_BLOCKS = 64;
+    // ... on inputs of at least this size: below it the treap walks of the index cost more
+    // than the element moves of the rotate backend (measured on std::vector and std::deque),
+    // block moves with the run time size only pay off up to a quarter of it
+    static const size_t INDEXED_MIN_ELEMENTS = 16384;
+    static const size_t INDEXED_MIN_ELEMENTS_RUNTIME_BLOCKS = 4096;
+    // levels with blocks of up to this many elements move them with a compile-time block size
+    static const size_t FIXED_BLOCK_MAX = 16;
+    // levels with fewer elements are never split between threads
+    static const size_t PARALLEL_MIN_ELEMENTS = 1 << 15;
+
+    // phases reported to the Probe policy
+    enum Phase { PHASE_PAIRING, PHASE_RESTRUCTURE, PHASE_INSERT, PHASE_COUNT };
+
+protected:
+    FordJohnsonBase();
+    ~FordJohnsonBase();
+
+    // J(0) ... J(33) from Jacobsthal<K> (SmallSort.hpp), J(33) is above every maxPending
+    static const size_t JACOBSTHAL_COUNT = 34;
+    static const unsigned int JACOBSTHAL[JACOBSTHAL_COUNT];
+
+    static std::vector<unsigned int> getJacobsthalIndexes(unsigned int n);
+    static void buildInsertOrder(size_t numPending, const std::vector<unsigned int>& JTseq, std::vector<unsigned int>& insertionOrder);
+    static size_t computeUsefulMainEnd(size_t k, size_t pendingPos, size_t blockSize);
+    static size_t computeK(unsigned int pendIndex, const std::vector<unsigned int>& JTseq);
+    static size_t getNumPending(size_t numBlocks);
+};
+
+template <typename Container,
+          typename KeyOf = IdentityKey<typename Container::value_type>,
+          typename Compare = std::less<typename KeyOf::key_type>,
+          typename Counter = NoComparisonCount,
+          typename Probe = NoPhaseProbe>
+class FordJohnson : public FordJohnsonBase
+{
+public:
+    typedef typename Container::value_type value_type;
+
+    FordJohnson(const KeyOf& keyOf = KeyOf(), const Compare& compare = Compare());
+    ~FordJohnson();
+
+    void sort(Container& data);
+    void sortPaired(Container& data);
+    const Counter& counter() const;
+    const Probe& probe() const;
+    void resetCounter();
+    void setInsertBackend(InsertBackend backend);
+    void setThreads(unsigned int threads);
+    void setSmallSortCutoff(size_t blocks);
+    void setFixedBlocks(bool enabled);
+
+private:
+    // one range of work for a thread: pairs of a level or blocks of the gather
+    struct Task
+    {
+        FordJohnson* engine;
+        Container* data;
+        size_t blockSize;
+        size_t first;
+        size_t last;
+        bool gather;
+        Counter counter;
+    };
+
+    // orders the blocks of the small sort kernel by their last element
+    struct BlockLess
+    {
+        FordJohnson& engine;
+        const Container& data;
+        size_t blockSize;
+
+        BlockLess(FordJohnson& engine, const Container& data, size_t blockSize);
+        bool operator()(unsigned char a, unsigned char b);
+    };
+
+    KeyOf keyOf;
+    Compare compare;
+    Counter comparisons;
+    Probe phaseProbe;
+    InsertBackend backend;
+    unsigned int threads;
+    size_t smallSortCutoff;
+    bool fixedBlocks;
+    ChainIndex chain;
+    std::vector<unsigned int> chainOrder;
+    std::vector<value_type> scratch;
+    std::vector<unsigned int> insertionOrder;
+    std::vector<Task> tasks;
+    std::vector<pthread_t> threadIds;
+    std::vector<bool> threadStarted;
+
+    bool less(const value_type& a, const value_type& b);
+    bool less(const value_type& a, const value_type& b, Counter& counter);
+    void sortFromLevel(Container& data, size_t firstLevel);
+    size_t sortPairsRecursively(Container& data, size_t recDepth);
+    void sortSmallBlocks(Container& data, size_t blockSize, size_t numBlocks);
+    void comparePairs(Container& data, size_t blockSize, size_t firstPair, size_t lastPair, Counter& counter);
+    template <size_t N>
+    void comparePairsSized(Container& data, size_t blockSize, size_t firstPair, size_t lastPair, Counter& counter);
+    void gatherBlocks(Container& data, size_t blockSize, size_t firstBlock, size_t lastBlock);
+    template <size_t N>
+    void gatherBlocksSized(Container& data, size_t blockSize, size_t firstBlock, size_t lastBlock);
+    void moveBlock(Container& data, size_t insertPos, size_t start, size_t blockSize);
+    size_t fixedBlockSize(size_t blockSize) const;
+    void runParallel(Container& data, size_t blockSize, size_t count, bool gather);
+    static void* runTask(void* arg);
+    void insertPendingBlocks(Container& data, size_t blockSize, size_t numPending, const std::vector<unsigned int>& JTseq);
+    void insertPendingBlocksRotate(Container& data, size_t blockSize, size_t numPending, const std::vector<unsigned int>& JTseq);
+    void insertPendingBlocksIndexed(Container& data, size_t blockSize, size_t numPending, const std::vector<unsigned int>& JTseq);
+    size_t binaryInsertBlock(const Container& data, const value_type& value, size_t blockSize, size_t numBlocks);
+    size_t binaryInsertIndexed(const Container& data, const value_type& value, size_t blockSize, size_t numBlocks);
+    size_t sortMainPendb2b(Container& data, size_t blockSize);
+    template <size_t N>
+    size_t sortMainPendb2bSized(Container& data, size_t blockSize);
+};
+
+/*
+Library entry points for callers that only want their data sorted:
+- mergeInsertionSort(data)          sorts the caller's container in place
+- mergeInsertionSort(input, output) takes over the buffer of input (swap, C++98 has no move),
+                                    input is left empty, no element is copied
+Besides the data the engine needs its scratch arena (n elements) and, for large rounds,
+the chain index (20 bytes per block, see ChainIndex.hpp).
+*/
+template <typename Container>
+void mergeInsertionSort(Container& data)
+{
+    FordJohnson<Container> engine;
+    engine.sort(data);
+}
+
+template <typename Container>
+void mergeInsertionSort(Container& input, Container& output)
+{
+    output.swap(input);
+    Container().swap(input); // releases the old buffer of output
+    mergeInsertionSort(output);
+}
+
+#include "FordJohnson.tpp"
+
+#endif
@@ -0,0 +1,526 @@
+// template implementation of the Ford-Johnson engine, included by FordJohnson.hpp
+
+// Constructor
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+FordJohnson<Container, KeyOf, Compare, Counter, Probe>::FordJohnson(const KeyOf& keyOf, const Compare& compare)
+    : keyOf(keyOf), compare(compare), comparisons(), phaseProbe(), backend(AUTO_INSERT), threads(1),
+      smallSortCutoff(SMALL_SORT_MAX), fixedBlocks(true) {}
+
+// Destructor
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+FordJohnson<Container, KeyOf, Compare, Counter, Probe>::~FordJohnson() {}
+
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+const Counter& FordJohnson<Container, KeyOf, Compare, Counter, Probe>::counter() const
+{
+    return comparisons;
+}
+
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+const Probe& FordJohnson<Container, KeyOf, Compare, Counter, Probe>::probe() const
+{
+    return phaseProbe;
+}
+
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+void FordJohnson<Container, KeyOf, Compare, Counter, Probe>::resetCounter()
+{
+    comparisons = Counter();
+}
+
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+void FordJohnson<Container, KeyOf, Compare, Counter, Probe>::setInsertBackend(InsertBackend newBackend)
+{
+    backend = newBackend;
+}
+
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+void FordJohnson<Container, KeyOf, Compare, Counter, Probe>::setThreads(unsigned int newThreads)
+{
+    threads = newThreads ? newThreads : 1;
+}
+
+// blocks larger than the largest kernel keep going through the rounds
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+void FordJohnson<Container, KeyOf, Compare, Counter, Probe>::setSmallSortCutoff(size_t blocks)
+{
+    smallSortCutoff = std::min(blocks, SMALL_SORT_MAX);
+}
+
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+void FordJohnson<Container, KeyOf, Compare, Counter, Probe>::setFixedBlocks(bool enabled)
+{
+    fixedBlocks = enabled;
+}
+
+// the block size as it is dispatched to the sized functions (block sizes are powers of two), 0 = run time size
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+size_t FordJohnson<Container, KeyOf, Compare, Counter, Probe>::fixedBlockSize(size_t blockSize) const
+{
+    return fixedBlocks && blockSize <= FIXED_BLOCK_MAX ? blockSize : 0;
+}
+
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+FordJohnson<Container, KeyOf, Compare, Counter, Probe>::BlockLess::BlockLess(FordJohnson& engine, const Container& data, size_t blockSize)
+    : engine(engine), data(data), blockSize(blockSize) {}
+
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+bool FordJohnson<Container, KeyOf, Compare, Counter, Probe>::BlockLess::operator()(unsigned char a, unsigned char b)
+{
+    return engine.less(data[a * blockSize + blockSize - 1], data[b * blockSize + blockSize - 1]);
+}
+
+// the only place where two elements are compared, so the counting policy sees every comparison
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+bool FordJohnson<Container, KeyOf, Compare, Counter, Probe>::less(const value_type& a, const value_type& b)
+{
+    return less(a, b, comparisons);
+}
+
+// worker threads count into their own counter, merged after the join
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+bool FordJohnson<Container, KeyOf, Compare, Counter, Probe>::less(const value_type& a, const value_type& b, Counter& counter)
+{
+    counter.tick();
+    return compare(keyOf(a), keyOf(b));
+}
+
+// execution of the Ford-Johnson algorithm, sorts data in place
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+void FordJohnson<Container, KeyOf, Compare, Counter, Probe>::sort(Container& data)
+{
+    sortFromLevel(data, 1);
+}
+
+// same as sort(), the caller already ordered every pair: data[2i] <= data[2i + 1] (AdaptiveSort)
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+void FordJohnson<Container, KeyOf, Compare, Counter, Probe>::sortPaired(Container& data)
+{
+    sortFromLevel(data, 2);
+}
+
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+void FordJohnson<Container, KeyOf, Compare, Counter, Probe>::sortFromLevel(Container& data, size_t firstLevel)
+{
+    if (data.size() <= 1) // already sorted
+        return;
+    if (threads > 1) { // the tasks of every parallel level
+        tasks.resize(threads);
+        threadIds.resize(threads);
+        threadStarted.resize(threads);
+    }
+
+    // Step 1: determine how many insertion rounds we need to run and recursively swap blocks
+    phaseProbe.begin(PHASE_PAIRING);
+    size_t recDepth = sortPairsRecursively(data, firstLevel);
+    phaseProbe.end(PHASE_PAIRING);
+    // Step 1b: the blocks of the level where the pairing stopped go through one small sort kernel
+    size_t topBlockSize = static_cast<size_t>(1) << recDepth;
+    if (data.size() / topBlockSize >= 2) {
+        phaseProbe.begin(PHASE_INSERT);
+        sortSmallBlocks(data, topBlockSize, data.size() / topBlockSize);
+        phaseProbe.end(PHASE_INSERT);
+    }
+    if (recDepth == 0) // the kernel sorted every element
+        return;
+    // Step 2: calculate maxPending elements to know where to cut off Jacobsthal Sequence
+    size_t maxPending = data.size() / 2 + 1; // '+1' to accommodate for potential leftover
+    // Step 3: calculate Jacobsthal sequence
+    std::vector<unsigned int> JTseq = getJacobsthalIndexes(maxPending);
+    // Step 4: size every buffer once for the largest round (blockSize 1)
+    scratch.resize(data.size());
+    insertionOrder.reserve(maxPending);
+    if (backend != ROTATE_INSERT) {
+        chain.reserve(data.size());
+        chainOrder.reserve(data.size());
+    }
+
+    while (recDepth > 0)
+    {
+        size_t blockSize = static_cast<size_t>(1) << (recDepth - 1); // '1<<n' -> '2^n' e.g. 1 << (4 - 1) = 1 << 3 = 2^3 = 8
+        size_t numBlocks = data.size() / blockSize;
+        size_t numPending = getNumPending(numBlocks); // calculate the number of pending blocks
+
+        // Step 5: insert pending elements into the sequence
+        if (numPending > 1) // no need to insert anything if there's only 1 pending element
+            insertPendingBlocks(data, blockSize, numPending, JTseq);
+        --recDepth;
+    }
+}
+
+// function recursively compares pairs of blocks by their last elements and swaps them if needed
+/**
+ * Example with sequence [11, 2, 17, 0, 16, 8, 6, 15, 10, 3, 21, 1, 18, 9, 14, 19, 12, 5, 4, 20, 13]:
+ *
+ * Level 1 (blockSize=1): Compare individual elements
+ *   [11,2] → 11>2? YES → swap → [2,11]
+ *   [17,0] → 17>0? YES → swap → [0,17]
+ *   [16,8] → 16>8? YES → swap → [8,16]
+ *   Result: [2,11,0,17,8,16,6,15,3,10,1,21,9,18,14,19,5,12,4,20,13]
+ *
+ * Level 2 (blockSize=2): Compare blocks of size 2
+ *   [2,11] vs [0,17] → 11>17? NO → no swap
+ *   [8,16] vs [6,15] → 16>15? YES → swap → [6,15,8,16]
+ *     ...
+ *   Result: [2,11,0,17,6,15,8,16,3,10,1,21,9,18,14,19,5,12,4,20,13]
+ *
+ * Level 3 (blockSize=4): Compare blocks of size 4
+ *   [2,11,0,17] vs [6,15,8,16] → 17>16? YES → swap entire blocks
+ *   [3,10,1,21] vs [9,18,14,19] → 21>19? YES → swap entire blocks
+ *   [5,12,4,20] vs [13] → (only one block, no comparison needed)
+ *   Result: [6,15,8,16,2,11,0,17,3,10,1,21,9,18,14,19,5,12,4,20,13]
+ */
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+size_t FordJohnson<Container, KeyOf, Compare, Counter, Probe>::sortPairsRecursively(Container& data, size_t recDepth)
+{
+    size_t blockSize = static_cast<size_t>(1) << (recDepth - 1); // blockSize doubles each recursion: 1 -> 2 -> 4 -> ...
+    size_t numBlocks = data.size() / blockSize; // number of blocks to process
+
+    // base case: no more blocks to compare with one another, or few enough for a small sort kernel
+    if (numBlocks <= 1 || numBlocks <= smallSortCutoff)
+        return recDepth - 1; // returns the last level that needs an insertion round
+
+    // compare the last element of every pair of blocks & swap blocks if needed (pairs are disjoint)
+    size_t numPairs = numBlocks / 2;
+    if (threads > 1 && numPairs * 2 * blockSize >= PARALLEL_MIN_ELEMENTS)
+        runParallel(data, blockSize, numPairs, false);
+    else
+        comparePairs(data, blockSize, 0, numPairs, comparisons);
+    return sortPairsRecursively(data, recDepth + 1);
+}
+
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+void FordJohnson<Container, KeyOf, Compare, Counter, Probe>::comparePairs(Container& data, size_t blockSize, size_t firstPair, size_t lastPair, Counter& counter)
+{
+    switch (fixedBlockSize(blockSize))
+    {
+        case 1: comparePairsSized<1>(data, blockSize, firstPair, lastPair, counter); break;
+        case 2: comparePairsSized<2>(data, blockSize, firstPair, lastPair, counter); break;
+        case 4: comparePairsSized<4>(data, blockSize, firstPair, lastPair, counter); break;
+        case 8: comparePairsSized<8>(data, blockSize, firstPair, lastPair, counter); break;
+        case 16: comparePairsSized<16>(data, blockSize, firstPair, lastPair, counter); break;
+        default: comparePairsSized<0>(data, blockSize, firstPair, lastPair, counter); break;
+    }
+}
+
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+template <size_t N>
+void FordJohnson<Container, KeyOf, Compare, Counter, Probe>::comparePairsSized(Container& data, size_t blockSize, size_t firstPair, size_t lastPair, Counter& counter)
+{
+    const size_t size = FjBlock<N>::size(blockSize);
+
+    for (size_t i = firstPair * 2*size; i < lastPair * 2*size; i += 2*size)
+    {
+        if (less(data[i + 2*size - 1], data[i + size - 1], counter))
+            std::swap_ranges(data.begin() + i, data.begin() + i + size, data.begin() + i + size);
+    }
+}
+
+/*
+Sorts the blocks of the level where the pairing stopped (2 ... smallSortCutoff blocks) by their
+last element. This does what the pairing of the remaining levels and their insertion rounds would do,
+with the same worst case. The blocks move once through the scratch arena, the tail stays at the end.
+*/
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+void FordJohnson<Container, KeyOf, Compare, Counter, Probe>::sortSmallBlocks(Container& data, size_t blockSize, size_t numBlocks)
+{
+    unsigned char order[SMALL_SORT_MAX];
+    BlockLess byLastElement(*this, data, blockSize);
+
+    for (size_t i = 0; i < numBlocks; ++i)
+        order[i] = static_cast<unsigned char>(i);
+    smallSort(order, numBlocks, byLastElement);
+
+    scratch.resize(data.size());
+    typename std::vector<value_type>::iterator out = scratch.begin();
+    for (size_t i = 0; i < numBlocks; ++i)
+    {
+        typename Container::iterator first = data.begin() + order[i] * blockSize;
+        out = std::copy(first, first + blockSize, out);
+    }
+    std::copy(data.begin() + numBlocks * blockSize, data.end(), out); // tail
+    fjAdoptScratch(data, scratch);
+}
+
+// copies the blocks at chain positions [firstBlock, lastBlock) to their final place in the scratch arena
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+void FordJohnson<Container, KeyOf, Compare, Counter, Probe>::gatherBlocks(Container& data, size_t blockSize, size_t firstBlock, size_t lastBlock)
+{
+    switch (fixedBlockSize(blockSize))
+    {
+        case 1: gatherBlocksSized<1>(data, blockSize, firstBlock, lastBlock); break;
+        case 2: gatherBlocksSized<2>(data, blockSize, firstBlock, lastBlock); break;
+        case 4: gatherBlocksSized<4>(data, blockSize, firstBlock, lastBlock); break;
+        case 8: gatherBlocksSized<8>(data, blockSize, firstBlock, lastBlock); break;
+        case 16: gatherBlocksSized<16>(data, blockSize, firstBlock, lastBlock); break;
+        default: gatherBlocksSized<0>(data, blockSize, firstBlock, lastBlock); break;
+    }
+}
+
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+template <size_t N>
+void FordJohnson<Container, KeyOf, Compare, Counter, Probe>::gatherBlocksSized(Container& data, size_t blockSize, size_t firstBlock, size_t lastBlock)
+{
+    const size_t size = FjBlock<N>::size(blockSize);
+
+    typename std::vector<value_type>::iterator out = scratch.begin() + firstBlock * size;
+    for (size_t i = firstBlock; i < lastBlock; ++i)
+    {
+        typename Container::iterator first = data.begin() + chainOrder[i] * size;
+        out = std::copy(first, first + size, out);
+    }
+}
+
+// moves the pending block at start to insertPos in front of it (rotate backend)
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+void FordJohnson<Container, KeyOf, Compare, Counter, Probe>::moveBlock(Container& data, size_t insertPos, size_t start, size_t blockSize)
+{
+    switch (fixedBlockSize(blockSize))
+    {
+        case 1: fjMoveFixedBlock<1>(data, insertPos, start); break;
+        case 2: fjMoveFixedBlock<2>(data, insertPos, start); break;
+        case 4: fjMoveFixedBlock<4>(data, insertPos, start); break;
+        case 8: fjMoveFixedBlock<8>(data, insertPos, start); break;
+        case 16: fjMoveFixedBlock<16>(data, insertPos, start); break;
+        default: fjMoveBlock(data, insertPos, start, start + blockSize); break;
+    }
+}
+
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+void* FordJohnson<Container, KeyOf, Compare, Counter, Probe>::runTask(void* arg)
+{
+    Task* task = static_cast<Task*>(arg);
+    if (task->gather)
+        task->engine->gatherBlocks(*task->data, task->blockSize, task->first, task->last);
+    else
+        task->engine->comparePairs(*task->data, task->blockSize, task->first, task->last, task->counter);
+    return NULL;
+}
+
+// splits 'count' pairs (or blocks) into one range per thread, the calling thread takes the first range
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+void FordJohnson<Container, KeyOf, Compare, Counter, Probe>::runParallel(Container& data, size_t blockSize, size_t count, bool gather)
+{
+    for (unsigned int t = 0; t < threads; ++t)
+    {
+        tasks[t].engine = this;
+        tasks[t].data = &data;
+        tasks[t].blockSize = blockSize;
+        tasks[t].first = count * t / threads;
+        tasks[t].last = count * (t + 1) / threads;
+        tasks[t].gather = gather;
+        tasks[t].counter = Counter();
+    }
+    for (unsigned int t = 1; t < threads; ++t)
+        threadStarted[t] = pthread_create(&threadIds[t], NULL, &runTask, &tasks[t]) == 0;
+    runTask(&tasks[0]);
+    for (unsigned int t = 1; t < threads; ++t)
+    {
+        if (threadStarted[t])
+            pthread_join(threadIds[t], NULL);
+        else
+            runTask(&tasks[t]); // no thread available, do the work here
+    }
+    for (unsigned int t = 0; t < threads; ++t)
+        comparisons.merge(tasks[t].counter);
+}
+
+// inserts pending elements into the main chain using the optimal Ford Johnson insertion order
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+void FordJohnson<Container, KeyOf, Compare, Counter, Probe>::insertPendingBlocks(Container& data, size_t blockSize, size_t numPending, const std::vector<unsigned int>& JTseq)
+{
+    size_t indexedMinElements = fixedBlocks ? INDEXED_MIN_ELEMENTS : INDEXED_MIN_ELEMENTS_RUNTIME_BLOCKS;
+    bool indexed = backend == INDEXED_INSERT
+        || (backend == AUTO_INSERT && data.size() >= indexedMinElements
+            && data.size() / blockSize >= INDEXED_MIN_BLOCKS);
+    if (indexed)
+        insertPendingBlocksIndexed(data, blockSize, numPending, JTseq);
+    else
+        insertPendingBlocksRotate(data, blockSize, numPending, JTseq);
+}
+
+/*
+Bookkeeping shared by both backends, without rescanning the insertion order:
+
+insertion order [1] [3, 2] [5, 4] [11, 10, 9, 8, 7, 6] ...  -> groups start where the index goes up
+- within a group the indexes go down, so every pending element inserted before the current one
+  with a smaller index belongs to an earlier group: numMovedBefore = elements inserted before the group
+- k (how many main chain blocks the binary search may look at) is the same for the whole group
+*/
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+void FordJohnson<Container, KeyOf, Compare, Counter, Probe>::insertPendingBlocksRotate(Container& data, size_t blockSize, size_t numPending, const std::vector<unsigned int>& JTseq)
+{
+    // Step 1: separate main chain from pending elements -> returns where the pending elements start
+    phaseProbe.begin(PHASE_RESTRUCTURE);
+    size_t pendingPos = sortMainPendb2b(data, blockSize);
+    phaseProbe.end(PHASE_RESTRUCTURE);
+    phaseProbe.begin(PHASE_INSERT);
+    // Step 2: create optimal insertion sequence using Jacobsthal numbers
+    buildInsertOrder(numPending, JTseq, insertionOrder);
+    unsigned int prevIndex = 0;
+    size_t k = 0;
+    size_t numMovedBefore = 0;
+    // Step 3: insert pending elements one by one
+    for (size_t i = 0; i < insertionOrder.size(); ++i)
+    {
+        unsigned int pendIndex = insertionOrder[i]; // index of the pending element to insert
+        if (pendIndex > prevIndex) { // a new Jacobsthal group starts
+            k = computeK(pendIndex, JTseq);
+            numMovedBefore = i;
+        }
+        prevIndex = pendIndex;
+
+        // find exact start/end positions of the pending block to insert
+        size_t start = pendingPos + (pendIndex - 1 - numMovedBefore) * blockSize;
+        size_t end = start + blockSize;
+
+        // calculate how many main chain elements to consider for binary search (limit comparisons to relevant ones)
+        size_t usefulMainElements = computeUsefulMainEnd(k, pendingPos, blockSize);
+        // use binary search to find optimal insertion position for each pending block (no moves yet)
+        size_t insertPos;
+        if (pendIndex == 1) { // first pending element can be inserted right away
+            insertPos = 0;
+        } else {
+            insertPos = binaryInsertBlock(data, data[end - 1], blockSize, usefulMainElements);
+        }
+        // insert the pending block at the correct position (only if insertion point != current pos)
+        if (insertPos < start) // do nothing when insertPos == start
+            moveBlock(data, insertPos, start, blockSize);
+        pendingPos += blockSize; // main chain grew by one block
+    }
+    phaseProbe.end(PHASE_INSERT);
+}
+
+/*
+Same insertions as insertPendingBlocksRotate, but nothing is moved until the round is done:
+
+Blocks keep their place in the container, block number n covers data[n*blockSize ... (n+1)*blockSize - 1]
+    [b1][a1][b2][a2][b3][a3][tail]     pending block i is block number 2*(i-1), main blocks are the odd ones
+
+Step 1: the chain index starts with the main blocks   -> 1 3 5
+Step 2: every pending block is searched through the index and inserted into it (no element moves)
+Step 3: the blocks are copied once in chain order, the tail stays at the end
+*/
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+void FordJohnson<Container, KeyOf, Compare, Counter, Probe>::insertPendingBlocksIndexed(Container& data, size_t blockSize, size_t numPending, const std::vector<unsigned int>& JTseq)
+{
+    size_t numBlocks = data.size() / blockSize;
+
+    // Step 1: main chain = all odd (winner) blocks
+    phaseProbe.begin(PHASE_INSERT);
+    chain.clear();
+    for (size_t m = 0; m < numBlocks / 2; ++m)
+        chain.insert(m, 2 * m + 1);
+
+    // Step 2: insert the pending blocks into the index in Ford-Johnson order
+    buildInsertOrder(numPending, JTseq, insertionOrder);
+    unsigned int prevIndex = 0;
+    size_t k = 0;
+    for (size_t i = 0; i < insertionOrder.size(); ++i)
+    {
+        unsigned int pendIndex = insertionOrder[i];
+        if (pendIndex > prevIndex) // a new Jacobsthal group starts
+            k = computeK(pendIndex, JTseq);
+        prevIndex = pendIndex;
+
+        size_t block = 2 * (pendIndex - 1);
+        size_t rank = 0; // first pending element can be inserted right away
+        if (pendIndex != 1) {
+            size_t usefulMainBlocks = computeUsefulMainEnd(k, chain.size() * blockSize, blockSize);
+            rank = binaryInsertIndexed(data, data[block * blockSize + blockSize - 1], blockSize, usefulMainBlocks);
+        }
+        chain.insert(rank, block);
+    }
+    phaseProbe.end(PHASE_INSERT);
+
+    // Step 3: move every block to its final position in a single pass (through the scratch arena)
+    phaseProbe.begin(PHASE_RESTRUCTURE);
+    chain.toSequence(chainOrder);
+    if (threads > 1 && numBlocks * blockSize >= PARALLEL_MIN_ELEMENTS)
+        runParallel(data, blockSize, numBlocks, true);
+    else
+        gatherBlocks(data, blockSize, 0, numBlocks);
+    std::copy(data.begin() + numBlocks * blockSize, data.end(), scratch.begin() + numBlocks * blockSize); // tail
+    fjAdoptScratch(data, scratch);
+    phaseProbe.end(PHASE_RESTRUCTURE);
+}
+
+// rearranges the container to make the main chain and pending elements contiguous to make insertion easier
+// Before (scattered): [Pending][Main][Pending][Main][Pending][Main]
+// After (contiguous):  [Main Chain][Pending Elements]
+/*
+Example:
+* Before: [2, 11, 0, 17][8, 16, 6, 15][3, 10, 1, 21][9, 18, 14, 19][5, 12, 4, 20][13]
+*          ↑ Main Chain ↑  ↑ Pending ↑  ↑ Main Chain ↑  ↑ Pending ↑  ↑ Main Chain ↑  ↑ Pending ↑
+*
+* After:  [2, 11, 0, 17, 3, 10, 1, 21, 5, 12, 4, 20][8, 16, 6, 15, 9, 18, 14, 19, 13]
+*          ↑                    Main Chain                    ↑  ↑        Pending        ↑
+*/
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+size_t FordJohnson<Container, KeyOf, Compare, Counter, Probe>::sortMainPendb2b(Container& data, size_t blockSize)
+{
+    switch (fixedBlockSize(blockSize))
+    {
+        case 1: return sortMainPendb2bSized<1>(data, blockSize);
+        case 2: return sortMainPendb2bSized<2>(data, blockSize);
+        case 4: return sortMainPendb2bSized<4>(data, blockSize);
+        case 8: return sortMainPendb2bSized<8>(data, blockSize);
+        case 16: return sortMainPendb2bSized<16>(data, blockSize);
+        default: return sortMainPendb2bSized<0>(data, blockSize);
+    }
+}
+
+// block by block: odd (winner) blocks go to the main chain, even blocks, the leftover block
+// and the incomplete tail to the pending elements, both in their original order
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+template <size_t N>
+size_t FordJohnson<Container, KeyOf, Compare, Counter, Probe>::sortMainPendb2bSized(Container& data, size_t blockSize)
+{
+    const size_t size = FjBlock<N>::size(blockSize);
+    size_t numPairs = data.size() / size / 2; // main chain = every complete odd block
+
+    typename std::vector<value_type>::iterator mainOut = scratch.begin();
+    typename std::vector<value_type>::iterator pendingOut = scratch.begin() + numPairs * size;
+    typename Container::iterator block = data.begin();
+    for (size_t p = 0; p < numPairs; ++p, block += 2 * size)
+    {
+        pendingOut = std::copy(block, block + size, pendingOut);
+        mainOut = std::copy(block + size, block + 2 * size, mainOut);
+    }
+    std::copy(block, data.end(), pendingOut);
+    fjAdoptScratch(data, scratch);
+    return numPairs * size;
+}
+
+// returns the position where the new element should be inserted in the main chain
+// instead of searching each individual only searches blocks
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+size_t FordJohnson<Container, KeyOf, Compare, Counter, Probe>::binaryInsertBlock(const Container& data, const value_type& value, size_t blockSize, size_t numBlocks)
+{
+    // define the search range
+    size_t left = 0;
+    size_t right = numBlocks;
+
+    while (left < right) {
+        size_t mid = (left + right) / 2; // find the middle block
+        // compare with the last element of the middle block
+        if (less(value, data[(blockSize - 1) + mid*blockSize]))
+            right = mid;
+        else
+            left = mid + 1;
+    }
+    return left * blockSize; // convert block position to element position
+}
+
+// same binary search as binaryInsertBlock, the chain index picks the blocks (same probes)
+// returns the position in the chain (in blocks)
+template <typename Container, typename KeyOf, typename Compare, typename Counter, typename Probe>
+size_t FordJohnson<Container, KeyOf, Compare, Counter, Probe>::binaryInsertIndexed(const Container& data, const value_type& value, size_t blockSize, size_t numBlocks)
+{
+    size_t block;
+
+    chain.beginSearch(numBlocks);
+    while (chain.nextProbe(block))
+        chain.answerProbe(less(value, data[block * blockSize + blockSize - 1]));
+    return chain.searchResult();
+}
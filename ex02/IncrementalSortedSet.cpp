@@ -0,0 +1,119 @@
+#include "IncrementalSortedSet.hpp"
+#include "PmergeMe.hpp"
+
+IncrementalSortedSet::BatchStats::BatchStats()
+    : batchSize(0), residentSize(0), sortComparisons(0), mergeComparisons(0), linearMerge(false), seconds(0) {}
+
+// Constructor
+IncrementalSortedSet::IncrementalSortedSet() : totalComparisons(0) {}
+
+// Destructor
+IncrementalSortedSet::~IncrementalSortedSet() {}
+
+const TieredVector<unsigned int>& IncrementalSortedSet::values() const
+{
+    return resident;
+}
+
+size_t IncrementalSortedSet::size() const
+{
+    return resident.size();
+}
+
+unsigned long IncrementalSortedSet::comparisonCount() const
+{
+    return totalComparisons;
+}
+
+// first position >= start whose value is greater than 'value' (behind the equal ones)
+size_t IncrementalSortedSet::gallop(unsigned int value, size_t start, unsigned long& comparisons) const
+{
+    size_t n = resident.size();
+    size_t low = start;
+    size_t high = n;
+    size_t step = 1;
+
+    // exponential probes: start, start + 1, start + 3, start + 7, ...
+    while (true)
+    {
+        size_t probe = start + step - 1;
+        if (probe >= n)
+            break;
+        ++comparisons;
+        if (value < resident[probe]) {
+            high = probe;
+            break;
+        }
+        low = probe + 1;
+        step *= 2;
+    }
+    // binary search inside the last step
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+        ++comparisons;
+        if (value < resident[mid])
+            high = mid;
+        else
+            low = mid + 1;
+    }
+    return low;
+}
+
+// positions[j] is counted in the resident values before the batch, every earlier batch value shifts it by one
+void IncrementalSortedSet::insertEach(const std::vector<unsigned int>& batch)
+{
+    for (size_t j = 0; j < batch.size(); ++j)
+        resident.insert(positions[j] + j, batch[j]);
+}
+
+void IncrementalSortedSet::mergeAll(const std::vector<unsigned int>& batch)
+{
+    const TieredVector<unsigned int>& values = resident;
+    TieredVector<unsigned int>::const_iterator from = values.begin();
+
+    merged.clear();
+    merged.reserve(resident.size() + batch.size());
+    for (size_t j = 0; j < batch.size(); ++j)
+    {
+        TieredVector<unsigned int>::const_iterator to = values.begin() + positions[j];
+        merged.insert(merged.end(), from, to);
+        merged.push_back(batch[j]);
+        from = to;
+    }
+    merged.insert(merged.end(), from, values.end());
+    resident.assign(merged.begin(), merged.end());
+}
+
+// sorts the batch in place and adds it to the resident values
+const IncrementalSortedSet::BatchStats& IncrementalSortedSet::addBatch(std::vector<unsigned int>& batch)
+{
+    double start = PmergeMe::monotonicSeconds();
+
+    last = BatchStats();
+    last.batchSize = batch.size();
+
+    engine.resetCounter();
+    engine.sort(batch);
+    last.sortComparisons = engine.counter().count();
+
+    // the batch is sorted, so every search starts where the previous value went
+    positions.resize(batch.size());
+    size_t from = 0;
+    for (size_t j = 0; j < batch.size(); ++j)
+    {
+        from = gallop(batch[j], from, last.mergeComparisons);
+        positions[j] = from;
+    }
+
+    last.linearMerge = batch.size() * resident.chunkCapacity() >= resident.size();
+    if (last.linearMerge)
+        mergeAll(batch);
+    else
+        insertEach(batch);
+
+    last.residentSize = resident.size();
+    last.seconds = PmergeMe::monotonicSeconds() - start;
+    totalComparisons += last.sortComparisons + last.mergeComparisons;
+    return last;
+}
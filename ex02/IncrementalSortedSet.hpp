@@ -0,0 +1,70 @@
+#ifndef INCREMENTALSORTEDSET_HPP
+#define INCREMENTALSORTEDSET_HPP
+
+#include <vector>
+#include <cstddef>
+#include "FordJohnson.hpp"
+#include "TieredVector.hpp"
+
+/*
+Sorted sequence that grows in batches (online sorting):
+
+Sorting everything again after every batch costs O((n + m) log(n + m)) comparisons for a batch
+of m values. addBatch only pays for the batch:
+
+1. the batch is sorted by the Ford-Johnson engine             ~ m log2(m) comparisons
+2. every value of the batch is placed into the resident values with a galloping search that
+   starts where the previous (smaller) value went: exponential probes 1, 2, 4, ... then a
+   binary search inside the last step                         ~ m log2(n / m + 1) comparisons
+3. the values are moved in:
+   - few values (m * C < n): one TieredVector::insert each, O(sqrt(n)) moves per value
+   - many values: one linear merge pass, O(n + m) moves
+   the positions come from step 2 in both cases, so the comparisons do not depend on the path
+
+Equal values are kept (like the other PmergeMe engines), a new value goes behind the equal
+resident ones. Both engines count their comparisons, BatchStats reports them per batch.
+*/
+
+class IncrementalSortedSet
+{
+public:
+    struct BatchStats
+    {
+        size_t batchSize;
+        size_t residentSize;              // size after the batch
+        unsigned long sortComparisons;    // Ford-Johnson on the batch
+        unsigned long mergeComparisons;   // galloping placement
+        bool linearMerge;                 // moved by a merge pass instead of inserts
+        double seconds;
+
+        BatchStats();
+    };
+
+private:
+    typedef FordJohnson<std::vector<unsigned int>, IdentityKey<unsigned int>, std::less<unsigned int>, ComparisonCount> BatchEngine;
+
+    TieredVector<unsigned int> resident;
+    BatchEngine engine;
+    std::vector<size_t> positions; // insertion point of every batch value, kept between the batches
+    std::vector<unsigned int> merged;
+    BatchStats last;
+    unsigned long totalComparisons;
+
+    IncrementalSortedSet(const IncrementalSortedSet& other);
+    IncrementalSortedSet& operator=(const IncrementalSortedSet& other);
+
+    size_t gallop(unsigned int value, size_t start, unsigned long& comparisons) const;
+    void insertEach(const std::vector<unsigned int>& batch);
+    void mergeAll(const std::vector<unsigned int>& batch);
+
+public:
+    IncrementalSortedSet();
+    ~IncrementalSortedSet();
+
+    const BatchStats& addBatch(std::vector<unsigned int>& batch);
+    const TieredVector<unsigned int>& values() const;
+    size_t size() const;
+    unsigned long comparisonCount() const;
+};
+
+#endif
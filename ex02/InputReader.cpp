@@ -0,0 +1,165 @@
+#include "InputReader.hpp"
+#include <stdexcept>
+#include <climits>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace
+{
+    bool isSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    // closes the file descriptor when the scope is left (also on exceptions)
+    struct FileGuard
+    {
+        int fd;
+        explicit FileGuard(int fd) : fd(fd) {}
+        ~FileGuard() { if (fd >= 0) close(fd); }
+    };
+
+    std::runtime_error invalidInput()
+    {
+        return std::runtime_error("Please provide valid numeric positive arguments.");
+    }
+}
+
+/*
+Parses one number starting at pos (no leading whitespace), pos ends behind the digits.
+Returns false for anything operator>> into an int followed by an EOF check would reject.
+*/
+bool InputReader::parseToken(const char*& pos, const char* end, unsigned int& value)
+{
+    bool negative = false;
+    if (pos < end && (*pos == '+' || *pos == '-')) {
+        negative = *pos == '-';
+        ++pos;
+    }
+    if (pos == end || *pos < '0' || *pos > '9')
+        return false;
+
+    unsigned long number = 0;
+    while (pos < end && *pos >= '0' && *pos <= '9') {
+        number = number * 10 + (*pos - '0');
+        if (number > static_cast<unsigned long>(INT_MAX))
+            return false;
+        ++pos;
+    }
+    if (negative && number != 0)
+        return false;
+    value = static_cast<unsigned int>(number);
+    return true;
+}
+
+// same rules for 64-bit keys, up to ULLONG_MAX
+bool InputReader::parseToken(const char*& pos, const char* end, unsigned long long& value)
+{
+    bool negative = false;
+    if (pos < end && (*pos == '+' || *pos == '-')) {
+        negative = *pos == '-';
+        ++pos;
+    }
+    if (pos == end || *pos < '0' || *pos > '9')
+        return false;
+
+    unsigned long long number = 0;
+    while (pos < end && *pos >= '0' && *pos <= '9') {
+        unsigned int digit = *pos - '0';
+        if (number > (ULLONG_MAX - digit) / 10)
+            return false;
+        number = number * 10 + digit;
+        ++pos;
+    }
+    if (negative && number != 0)
+        return false;
+    value = number;
+    return true;
+}
+
+// two passes: count the tokens and reserve once, then convert them
+void InputReader::parseBuffer(const char* begin, const char* end, std::vector<unsigned int>& out)
+{
+    size_t tokens = 0;
+    for (const char* p = begin; p < end; ++p) {
+        if (!isSpace(*p) && (p == begin || isSpace(p[-1])))
+            ++tokens;
+    }
+    out.reserve(out.size() + tokens);
+
+    const char* pos = begin;
+    while (pos < end)
+    {
+        if (isSpace(*pos)) {
+            ++pos;
+            continue;
+        }
+        unsigned int value;
+        if (!parseToken(pos, end, value) || (pos < end && !isSpace(*pos)))
+            throw invalidInput();
+        out.push_back(value);
+    }
+}
+
+// reads until EOF, grows the buffer geometrically (the size of a pipe is not known in advance)
+size_t InputReader::readAll(int fd, std::vector<char>& buffer)
+{
+    struct stat st;
+    size_t used = 0;
+
+    buffer.resize(fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 ? st.st_size + 1 : 1 << 20);
+    while (true)
+    {
+        if (used == buffer.size())
+            buffer.resize(buffer.size() * 2);
+        ssize_t got = ::read(fd, &buffer[used], buffer.size() - used);
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got < 0)
+            throw std::runtime_error(std::string("Error: read failed: ") + std::strerror(errno));
+        if (got == 0)
+            break;
+        used += got;
+    }
+    return used;
+}
+
+size_t InputReader::read(Source source, const std::string& path, std::vector<unsigned int>& out)
+{
+    FileGuard file(source == FROM_STDIN ? -1 : open(path.c_str(), O_RDONLY));
+    int fd = source == FROM_STDIN ? STDIN_FILENO : file.fd;
+    if (fd < 0)
+        throw std::runtime_error("Error: could not open " + path + ": " + std::strerror(errno));
+
+    if (source == FROM_MMAP)
+    {
+        struct stat st;
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+            throw std::runtime_error("Error: " + path + " is not a regular file, it cannot be mapped");
+        size_t size = st.st_size;
+        if (size == 0)
+            return 0;
+        void* mapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED)
+            throw std::runtime_error("Error: mmap of " + path + " failed: " + std::strerror(errno));
+        madvise(mapped, size, MADV_SEQUENTIAL);
+        const char* data = static_cast<const char*>(mapped);
+        try {
+            parseBuffer(data, data + size, out);
+        } catch (...) {
+            munmap(mapped, size);
+            throw;
+        }
+        munmap(mapped, size);
+        return size;
+    }
+
+    std::vector<char> buffer;
+    size_t size = readAll(fd, buffer);
+    parseBuffer(&buffer[0], &buffer[0] + size, out);
+    return size;
+}
@@ -0,0 +1,42 @@
+#ifndef INPUTREADER_HPP
+#define INPUTREADER_HPP
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+/*
+Fast ingestion of the numbers to sort:
+
+argv is limited to a few MB, tens of millions of values have to come from a file or a pipe:
+- FROM_FILE:  read() of the whole file into one buffer
+- FROM_MMAP:  the file is mapped into memory and parsed in place, no copy at all
+- FROM_STDIN: read() of stdin until EOF (pipes, redirections)
+
+The parser works on raw bytes instead of one istringstream per number. It first counts the
+tokens to reserve the vector once, then converts them. The rules are the ones of the argv parser:
+- tokens are separated by whitespace
+- optional '+' sign, digits only, no trailing garbage ("12a" is rejected)
+- non-negative values up to INT_MAX ("-0" is 0, like operator>> reads it)
+- the 64-bit overload of parseToken (--u64) takes the whole unsigned range instead
+*/
+
+class InputReader
+{
+public:
+    enum Source { FROM_FILE, FROM_MMAP, FROM_STDIN };
+
+private:
+    InputReader();
+
+    static size_t readAll(int fd, std::vector<char>& buffer);
+
+public:
+    static bool parseToken(const char*& pos, const char* end, unsigned int& value);
+    static bool parseToken(const char*& pos, const char* end, unsigned long long& value);
+    static void parseBuffer(const char* begin, const char* end, std::vector<unsigned int>& out);
+    // appends the numbers of the source to 'out', returns the number of bytes read
+    static size_t read(Source source, const std::string& path, std::vector<unsigned int>& out);
+};
+
+#endif
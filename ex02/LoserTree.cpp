@@ -0,0 +1,89 @@
+#include "LoserTree.hpp"
+
+// Constructor, every run starts exhausted until setHead() gives it an element
+LoserTree::LoserTree(size_t k, const CostlyLess& compare)
+    : k(k), tree(k, k), heads(k + 1, 0), exhausted(k + 1, true), compare(compare), comparisons(0) {}
+
+// Destructor
+LoserTree::~LoserTree() {}
+
+void LoserTree::setHead(size_t run, unsigned int value)
+{
+    heads[run] = value;
+    exhausted[run] = false;
+}
+
+void LoserTree::setExhausted(size_t run)
+{
+    exhausted[run] = true;
+}
+
+/*
+true when run a wins against run b (a is smaller).
+Index k is the virtual run used while building, it wins against everything.
+Equal keys are indistinguishable, either run may win a tie.
+*/
+bool LoserTree::beats(size_t a, size_t b)
+{
+    if (a == k || b == k)
+        return a == k;
+    if (exhausted[a] || exhausted[b])
+        return !exhausted[a];
+    ++comparisons;
+    return compare(heads[a], heads[b]);
+}
+
+// replays the matches from the leaf of 'run' up to the root
+void LoserTree::replay(size_t run)
+{
+    size_t winnerRun = run;
+    for (size_t node = (run + k) / 2; node > 0; node /= 2)
+    {
+        if (beats(tree[node], winnerRun))
+            std::swap(tree[node], winnerRun);
+    }
+    tree[0] = winnerRun;
+}
+
+// plays the whole tournament once all heads are set
+void LoserTree::build()
+{
+    for (size_t i = 0; i < k; ++i)
+        tree[i] = k;
+    for (size_t run = k; run-- > 0; )
+        replay(run);
+}
+
+bool LoserTree::empty() const
+{
+    return k == 0 || exhausted[tree[0]];
+}
+
+size_t LoserTree::winner() const
+{
+    return tree[0];
+}
+
+unsigned int LoserTree::top() const
+{
+    return heads[tree[0]];
+}
+
+// the winner's run continues with the next element
+void LoserTree::replaceTop(unsigned int value)
+{
+    heads[tree[0]] = value;
+    replay(tree[0]);
+}
+
+// the winner's run is done
+void LoserTree::popTop()
+{
+    exhausted[tree[0]] = true;
+    replay(tree[0]);
+}
+
+unsigned long LoserTree::comparisonCount() const
+{
+    return comparisons;
+}
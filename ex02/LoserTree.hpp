@@ -0,0 +1,53 @@
+#ifndef LOSERTREE_HPP
+#define LOSERTREE_HPP
+
+#include <vector>
+#include <cstddef>
+#include "SortPlanner.hpp"
+
+/*
+Tournament tree of losers for the k-way merge of sorted runs:
+
+The leaves are the current heads of the k runs, every inner node keeps the loser of the
+match played there, node 0 keeps the overall winner (the smallest head).
+When the winner is replaced by the next element of its run, only the matches on the path
+from its leaf to the root are replayed -> ceil(log2(k)) comparisons per output element,
+independent of the other runs (a binary heap needs up to 2*log2(k)).
+
+Exhausted runs compare as +infinity without calling the comparator, so only real
+comparisons are counted.
+*/
+
+class LoserTree
+{
+private:
+    size_t k;
+    std::vector<size_t> tree;        // tree[0] = winner, tree[1..k-1] = losers of the inner nodes
+    std::vector<unsigned int> heads; // current element of every run
+    std::vector<bool> exhausted;
+    CostlyLess compare;
+    unsigned long comparisons;
+
+    bool beats(size_t a, size_t b);
+    void replay(size_t run);
+
+    LoserTree(const LoserTree& other);
+    LoserTree& operator=(const LoserTree& other);
+
+public:
+    LoserTree(size_t k, const CostlyLess& compare);
+    ~LoserTree();
+
+    void setHead(size_t run, unsigned int value);
+    void setExhausted(size_t run);
+    void build();
+
+    bool empty() const;
+    size_t winner() const;
+    unsigned int top() const;
+    void replaceTop(unsigned int value);
+    void popTop();
+    unsigned long comparisonCount() const;
+};
+
+#endif
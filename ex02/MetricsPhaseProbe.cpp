@@ -0,0 +1,29 @@
+#include "MetricsPhaseProbe.hpp"
+#include "Metrics.hpp"
+
+namespace
+{
+    // one timer per FordJohnsonBase::Phase, same order
+    const size_t PHASE_TIMERS[FordJohnsonBase::PHASE_COUNT] = {
+        Metrics::define("fj.pairing", Metrics::TIMER),
+        Metrics::define("fj.restructure", Metrics::TIMER),
+        Metrics::define("fj.insert", Metrics::TIMER)
+    };
+}
+
+// Constructor
+MetricsPhaseProbe::MetricsPhaseProbe() : startTime(-1) {}
+
+// Destructor
+MetricsPhaseProbe::~MetricsPhaseProbe() {}
+
+void MetricsPhaseProbe::begin(int)
+{
+    startTime = Metrics::enabled() ? Metrics::now() : -1;
+}
+
+void MetricsPhaseProbe::end(int phase)
+{
+    if (startTime >= 0)
+        Metrics::addTime(PHASE_TIMERS[phase], Metrics::now() - startTime);
+}
@@ -0,0 +1,25 @@
+#ifndef METRICSPHASEPROBE_HPP
+#define METRICSPHASEPROBE_HPP
+
+#include "FordJohnson.hpp"
+
+/*
+Probe policy of the Ford-Johnson engine that reports the phases through --metrics=json:
+adds the wall time of every phase to the timers fj.pairing, fj.restructure and fj.insert.
+While the metrics are disabled begin() and end() only read the flag, so the engines of the
+regular sort use it instead of NoPhaseProbe.
+*/
+class MetricsPhaseProbe
+{
+private:
+    double startTime;
+
+public:
+    MetricsPhaseProbe();
+    ~MetricsPhaseProbe();
+
+    void begin(int phase);
+    void end(int phase);
+};
+
+#endif
@@ -0,0 +1,161 @@
+#include "PerfCounters.hpp"
+#include "PmergeMe.hpp"
+#include <iomanip>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+namespace
+{
+    // glibc has no wrapper for this system call
+    int openEvent(unsigned int type, unsigned long long config)
+    {
+        struct perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    unsigned long long cacheMiss(unsigned long long cache)
+    {
+        return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    }
+}
+
+PerfCounters::Reading::Reading()
+{
+    for (int e = 0; e < EVENT_COUNT; ++e)
+        value[e] = 0;
+}
+
+// Constructor, opens (and starts) every event that is available
+PerfCounters::PerfCounters()
+{
+    fds[CYCLES] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    fds[INSTRUCTIONS] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    fds[L1D_MISSES] = openEvent(PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_L1D));
+    fds[LLC_MISSES] = openEvent(PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_LL));
+    fds[BRANCH_MISSES] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+
+    for (int e = 0; e < EVENT_COUNT; ++e) {
+        if (fds[e] >= 0)
+            return;
+    }
+    failure = std::string("perf_event_open failed: ") + std::strerror(errno);
+}
+
+// Destructor
+PerfCounters::~PerfCounters()
+{
+    for (int e = 0; e < EVENT_COUNT; ++e) {
+        if (fds[e] >= 0)
+            close(fds[e]);
+    }
+}
+
+bool PerfCounters::available() const
+{
+    return failure.empty();
+}
+
+bool PerfCounters::available(Event event) const
+{
+    return fds[event] >= 0;
+}
+
+const std::string& PerfCounters::unavailableReason() const
+{
+    return failure;
+}
+
+// current value of every counter (0 for the unavailable ones), differences give the cost of a phase
+PerfCounters::Reading PerfCounters::read() const
+{
+    Reading reading;
+    for (int e = 0; e < EVENT_COUNT; ++e)
+    {
+        unsigned long long value = 0;
+        if (fds[e] >= 0 && ::read(fds[e], &value, sizeof(value)) == static_cast<ssize_t>(sizeof(value)))
+            reading.value[e] = value;
+    }
+    return reading;
+}
+
+const char* PerfCounters::eventName(Event event)
+{
+    const char* names[EVENT_COUNT] = {"cycles", "instructions", "L1d-misses", "LLC-misses", "branch-misses"};
+    return names[event];
+}
+
+// Constructor
+PerfPhaseProbe::PerfPhaseProbe() : startTime(0)
+{
+    for (int p = 0; p < FordJohnsonBase::PHASE_COUNT; ++p) {
+        seconds[p] = 0;
+        runs[p] = 0;
+    }
+}
+
+// Destructor
+PerfPhaseProbe::~PerfPhaseProbe() {}
+
+void PerfPhaseProbe::begin(int)
+{
+    startTime = PmergeMe::monotonicSeconds();
+    start = counters.read();
+}
+
+void PerfPhaseProbe::end(int phase)
+{
+    PerfCounters::Reading stop = counters.read();
+    seconds[phase] += PmergeMe::monotonicSeconds() - startTime;
+    ++runs[phase];
+    for (int e = 0; e < PerfCounters::EVENT_COUNT; ++e)
+        totals[phase].value[e] += stop.value[e] - start.value[e];
+}
+
+// one line per phase, "n/a" for the events the machine does not offer
+void PerfPhaseProbe::report(std::ostream& out, const std::string& label) const
+{
+    out << "Phase counters for " << label;
+    if (!counters.available()) {
+        out << ": unavailable (" << counters.unavailableReason() << ")" << std::endl;
+        return;
+    }
+    out << ":" << std::endl << "  " << std::setw(12) << "phase" << std::setw(8) << "runs" << std::setw(12) << "time (us)";
+    for (int e = 0; e < PerfCounters::EVENT_COUNT; ++e)
+        out << std::setw(15) << PerfCounters::eventName(static_cast<PerfCounters::Event>(e));
+    out << std::setw(8) << "IPC" << std::endl;
+
+    for (int p = 0; p < FordJohnsonBase::PHASE_COUNT; ++p)
+    {
+        out << "  " << std::setw(12) << phaseName(p) << std::setw(8) << runs[p]
+            << std::setw(12) << std::fixed << std::setprecision(0) << seconds[p] * 1e6;
+        for (int e = 0; e < PerfCounters::EVENT_COUNT; ++e) {
+            if (counters.available(static_cast<PerfCounters::Event>(e)))
+                out << std::setw(15) << totals[p].value[e];
+            else
+                out << std::setw(15) << "n/a";
+        }
+        unsigned long long cycles = totals[p].value[PerfCounters::CYCLES];
+        if (cycles && counters.available(PerfCounters::INSTRUCTIONS))
+            out << std::setw(8) << std::setprecision(2) << static_cast<double>(totals[p].value[PerfCounters::INSTRUCTIONS]) / cycles;
+        else
+            out << std::setw(8) << "n/a";
+        out << std::endl;
+    }
+    out.unsetf(std::ios::floatfield);
+    out << std::setprecision(6);
+}
+
+const char* PerfPhaseProbe::phaseName(int phase)
+{
+    const char* names[FordJohnsonBase::PHASE_COUNT] = {"pairing", "restructure", "insert"};
+    return names[phase];
+}
@@ -0,0 +1,79 @@
+#ifndef PERFCOUNTERS_HPP
+#define PERFCOUNTERS_HPP
+
+#include <string>
+#include <ostream>
+#include <cstddef>
+#include "FordJohnson.hpp"
+
+/*
+Hardware performance counters of the calling thread (Linux perf_event_open):
+
+    cycles, instructions, L1 data cache read misses, last level cache misses, branch misses
+
+Every event is opened on its own, so a CPU or VM that lacks one event still reports the others.
+Counters can be unavailable altogether (no PMU in the VM, perf_event_paranoid, seccomp in
+containers): available() is false then, the reason is kept for the report and every reading is 0.
+Only user space is counted, and only the thread that created the object (worker threads are not).
+*/
+
+class PerfCounters
+{
+public:
+    enum Event { CYCLES, INSTRUCTIONS, L1D_MISSES, LLC_MISSES, BRANCH_MISSES, EVENT_COUNT };
+
+    struct Reading
+    {
+        unsigned long long value[EVENT_COUNT];
+        Reading();
+    };
+
+private:
+    int fds[EVENT_COUNT];
+    std::string failure;
+
+    PerfCounters(const PerfCounters& other);
+    PerfCounters& operator=(const PerfCounters& other);
+
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    bool available() const;
+    bool available(Event event) const;
+    const std::string& unavailableReason() const;
+    Reading read() const;
+
+    static const char* eventName(Event event);
+};
+
+/*
+Probe policy of the Ford-Johnson engine (FordJohnson<..., PerfPhaseProbe>):
+reads the counters at begin(phase) and end(phase) and adds up the difference per phase,
+together with the wall time and the number of times the phase ran.
+*/
+class PerfPhaseProbe
+{
+private:
+    PerfCounters counters;
+    PerfCounters::Reading start;
+    double startTime;
+    PerfCounters::Reading totals[FordJohnsonBase::PHASE_COUNT];
+    double seconds[FordJohnsonBase::PHASE_COUNT];
+    unsigned long runs[FordJohnsonBase::PHASE_COUNT];
+
+    PerfPhaseProbe(const PerfPhaseProbe& other);
+    PerfPhaseProbe& operator=(const PerfPhaseProbe& other);
+
+public:
+    PerfPhaseProbe();
+    ~PerfPhaseProbe();
+
+    void begin(int phase);
+    void end(int phase);
+    void report(std::ostream& out, const std::string& label) const;
+
+    static const char* phaseName(int phase);
+};
+
+#endif
@@ -11,6 +11,20 @@
 #include <cstdio>
 #include <algorithm>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include "FordJohnson.hpp"
+#include "AllocationStats.hpp"
+#include "SortPlanner.hpp"
+#include "SimdSort.hpp"
+#include "InputReader.hpp"
+#include "PerfCounters.hpp"
+#include "MetricsPhaseProbe.hpp"
+#include "TieredVector.hpp"
+#include "IncrementalSortedSet.hpp"
+#include "Selection.hpp"
+#include "AdaptiveSort.hpp"
 
 /*
 Container usage justification:
@@ -23,6 +37,15 @@ Deque (double-ended queue, stored in multiple fixed-size chunks):
     - efficient end operations
     - show how it is less efficient than vector
 
+TieredVector (third container, chunks of about sqrt(n) elements kept as ring buffers):
+    - random access with a shift and a mask, the chunks are one contiguous array
+    - moves a pending block into the main chain in O(sqrt(n)) instead of O(n) (std::rotate),
+      so its engine uses the rotate backend: the container does the insertions itself
+
+Vector with the SIMD engine (third engine, cheap keys only):
+    - no comparison counting, compares 8 keys per instruction (AVX2) or none at all (radix)
+    - shows what Ford-Johnson pays for its minimal number of comparisons
+
 Why is deque so much slower:
 - vector has all elements in one continguous block (all in one cache line)
 - random access way faster for vector
@@ -33,8 +56,32 @@ Why is deque so much slower:
 class PmergeMe
 {
 private:
+    // both containers are sorted by the same Ford-Johnson engine (FordJohnson.hpp), with comparison counting
+    // and the phase timers of --metrics=json
+    typedef FordJohnson<std::vector<unsigned int>, IdentityKey<unsigned int>, std::less<unsigned int>, ComparisonCount, MetricsPhaseProbe> VectorEngine;
+    typedef FordJohnson<std::deque<unsigned int>, IdentityKey<unsigned int>, std::less<unsigned int>, ComparisonCount, MetricsPhaseProbe> DequeEngine;
+    // the tiered vector inserts the pending blocks itself (fjMoveBlock), so its engine always rotates
+    typedef FordJohnson<TieredVector<unsigned int>, IdentityKey<unsigned int>, std::less<unsigned int>, ComparisonCount, MetricsPhaseProbe> TieredEngine;
+    // same engines with hardware counters per phase (--perf)
+    typedef FordJohnson<std::vector<unsigned int>, IdentityKey<unsigned int>, std::less<unsigned int>, ComparisonCount, PerfPhaseProbe> VectorPerfEngine;
+    typedef FordJohnson<std::deque<unsigned int>, IdentityKey<unsigned int>, std::less<unsigned int>, ComparisonCount, PerfPhaseProbe> DequePerfEngine;
+    typedef FordJohnson<TieredVector<unsigned int>, IdentityKey<unsigned int>, std::less<unsigned int>, ComparisonCount, PerfPhaseProbe> TieredPerfEngine;
+    // 64-bit keys (--u64) and 32-bit key + 32-bit payload packed into one word (--width-bench)
+    typedef FordJohnson<std::vector<unsigned long long>, IdentityKey<unsigned long long>, std::less<unsigned long long>, ComparisonCount, MetricsPhaseProbe> WideVectorEngine;
+    typedef FordJohnson<std::deque<unsigned long long>, IdentityKey<unsigned long long>, std::less<unsigned long long>, ComparisonCount, MetricsPhaseProbe> WideDequeEngine;
+    typedef FordJohnson<std::vector<unsigned long long>, PackedKey<unsigned long long, 32>, std::less<unsigned long long>, ComparisonCount, MetricsPhaseProbe> PackedVectorEngine;
+
     std::deque<unsigned int> pmerge_deque;
     std::vector<unsigned int> pmerge_vector;
+    TieredVector<unsigned int> pmerge_tiered;
+    std::vector<unsigned int> pmerge_simd;
+    unsigned int threads; // worker threads of the engines (--threads N), 1 = sequential
+    bool perf; // hardware counters per phase (--perf)
+    bool lean; // only the vector engine, sorted in place, peak RSS reported (--lean)
+    bool adaptive; // the vector is sorted by AdaptiveSort (--adaptive)
+    size_t small_sort; // small sort cutoff of the engines in blocks (--small-sort N), 0 = none
+    std::string adaptive_path; // path AdaptiveSort took for the last vector
+    std::ostringstream perf_report; // printed after the regular output
 
     // Copy constructor
     PmergeMe(const PmergeMe &other);
@@ -42,37 +89,51 @@ private:
     PmergeMe &operator=(const PmergeMe &other);
     
     // Static counter for comparisons
-    static int comparison_count;
+    static unsigned long comparison_count; // wide enough for billions of elements
     
     // Debug printout functions
-    void printSequence(const std::string& label, const std::vector<unsigned int>& seq);
-    void printSequence(const std::string& label, const std::deque<unsigned int>& seq);
+    template <typename Container>
+    void printSequence(const std::string& label, const Container& seq);
     
-    // Ford-Johnson std::vector
-    std::vector<unsigned int> sortVecFordJohnson(const std::vector<unsigned int>& input);
-    int sortPairsRecursivelyVec(std::vector<unsigned int>& vec, int recDepth);
-    void insertPendingBlocksVec(std::vector<unsigned int>& vec, int blockSize, int numPending, const std::vector<unsigned int>& JTseq);
-    size_t binaryInsertBlockVec(const std::vector<unsigned int>& vec, unsigned int value, size_t blockSize, size_t numBlocks);
-    int sortMainPendb2b(std::vector<unsigned int>& vec, int blockSize);
+    // Ford-Johnson std::vector (sorts in place)
+    void sortVecFordJohnson(std::vector<unsigned int>& vec);
     
-    // Ford-Johnson std::deque
-    std::deque<unsigned int> sortDequeFordJohnson(const std::deque<unsigned int>& input);
-    int sortPairsRecursivelyDeque(std::deque<unsigned int>& deq, int recDepth);
-    void insertPendingBlocksDeque(std::deque<unsigned int>& deq, int blockSize, int numPending, const std::vector<unsigned int>& JTseq);
-    size_t binaryInsertBlockDeque(const std::deque<unsigned int>& deq, unsigned int value, size_t blockSize, size_t numBlocks);
-    int sortMainPendb2b(std::deque<unsigned int>& deq, int blockSize);
-
-    // algo helper functions
+    // AdaptiveSort: natural runs, few unique keys or Ford-Johnson (sorts in place)
+    void sortVecAdaptive(std::vector<unsigned int>& vec);
+
+    // Ford-Johnson std::deque (sorts in place)
+    void sortDequeFordJohnson(std::deque<unsigned int>& deq);
+
+    // Ford-Johnson TieredVector (sorts in place, rotate backend)
+    void sortTieredFordJohnson(TieredVector<unsigned int>& tiered);
+
+    // SIMD engine for cheap keys: AVX2 bitonic blocks / prefetching radix (sorts in place, no comparison count)
+    void sortVecSimd(std::vector<unsigned int>& vec);
+
+    // input parsing (into pmerge_vector, or into any vector of unsigned values)
     void checkArgs(int ac, char **av);
-    std::vector<unsigned int> getJacobsthalIndexes(unsigned int n);
-    std::vector<unsigned int> buildInsertOrder(int numPending, const std::vector<unsigned int>& JTseq);
-    size_t computeUsefulMainEnd(int k, size_t pendingPos, size_t blockSize);
-    size_t computeK(unsigned int pendIndex, const std::vector<unsigned int>& JTseq);
-    bool isMainChain(int index, int blockSize, int totalSize);
-    int getNumPending(int numBlocks);
-    size_t countSmallerPending(const std::vector<unsigned int>& insertionOrder, std::vector<unsigned int>::const_iterator endIt, unsigned int pendIndex);
+    template <typename T>
+    void checkArgs(int ac, char **av, std::vector<T>& values);
+
+    // sorts pmerge_vector with every engine and prints the results
+    void sortAndReport();
+    // sorts pmerge_vector in place without any copy and prints the memory it took
+    void sortLeanAndReport();
 
 public:
+    // settings of the benchmark sweep (--bench), see sweep.cpp
+    struct SweepOptions
+    {
+        std::vector<size_t> sizes;
+        std::vector<std::string> distributions;
+        unsigned int warmup;
+        unsigned int reps;
+        unsigned int seed;
+        bool json;
+
+        SweepOptions();
+    };
+
     // Constructor
     PmergeMe(void);
     // Deconstructor
@@ -80,16 +141,49 @@ public:
 
     // main function running the whole algo
     void runMergeInsertSort(int ac, char **av);
+    void runMergeInsertSort(InputReader::Source source, const std::string& path);
+    void setThreads(unsigned int threads);
+    void setPerf(bool enabled);
+    void setLean(bool enabled);
+    void setAdaptive(bool enabled);
+    void setSmallSort(size_t blocks);
+    // lets SortPlanner pick the engine, compareCostNs < 0: plain unsigned int comparison
+    void runPlannedSort(int ac, char **av, double compareCostNs);
+    // k-th smallest (from 0, like std::nth_element) or the k smallest in order, with Selection
+    void runSelection(int ac, char **av, size_t k, bool topK);
+    // adds the sequence in batches to an IncrementalSortedSet, reports the comparisons per batch
+    void runIncrementalSort(int ac, char **av, size_t batchSize);
+    // sorts the sequence as 64-bit keys with std::vector and std::deque (--u64)
+    void runWideSort(int ac, char **av);
     
     // static functions to calculate maximum comparisons according to Ford-Johnson algorithm
-    static int getComparisonCount();
+    static unsigned long getComparisonCount();
     static void resetComparisonCount();
-    static int maxComparisonsFJ(int n);
+    static unsigned long maxComparisonsFJ(size_t n);
     
     // sorting verification functions
     static bool isSorted(const std::vector<unsigned int>& vec);
     static bool isSorted(const std::deque<unsigned int>& deq);
-    static void verifySorting(const std::vector<unsigned int>& vec, const std::deque<unsigned int>& deq);
+    static bool isSorted(const TieredVector<unsigned int>& tiered);
+    static void verifySorting(const std::vector<unsigned int>& vec, const std::deque<unsigned int>& deq,
+                              const TieredVector<unsigned int>& tiered, const std::vector<unsigned int>& simd);
+
+    // benchmarks
+    static double monotonicSeconds();
+    static long peakRssKb();
+    static std::vector<unsigned int> randomSequence(size_t n, unsigned int seed);
+    static void runInsertBenchmark(size_t maxN, unsigned int threads);
+    static void runCrossoverBenchmark(size_t n);
+    static void runSelectionBenchmark(size_t n);
+    static void runSmallSortBenchmark();
+    static void runKeyWidthBenchmark(size_t maxN);
+    static int parseSweepOption(int ac, char **av, int i, SweepOptions& options);
+    static std::vector<unsigned int> makeSequence(const std::string& distribution, size_t n, unsigned int seed);
+    void sweepEngine(const std::string& engine, const std::string& distribution,
+                     const std::vector<unsigned int>& input, const SweepOptions& options, bool& first);
+    void runSweepBenchmark(const SweepOptions& options);
 };
 
+#include "PmergeMe.tpp"
+
 #endif
\ No newline at end of file
@@ -0,0 +1,35 @@
+// template implementation of PmergeMe, included by PmergeMe.hpp
+
+// parse through the input and check that it only includes valid integers of type T
+// every argument is one number, leading whitespace is skipped (like operator>> did)
+template <typename T>
+void PmergeMe::checkArgs(int ac, char **av, std::vector<T>& values)
+{
+    values.reserve(ac - 1);
+    for (int i = 1; i < ac; i++) 
+    {
+        const char* pos = av[i];
+        const char* end = pos + std::strlen(pos);
+        T value;
+
+        while (pos < end && std::isspace(static_cast<unsigned char>(*pos)))
+            ++pos;
+        // pos == end ensures no extra characters after the number (e.g. 12a would pass otherwise)
+        if (InputReader::parseToken(pos, end, value) && pos == end)
+            values.push_back(value);
+        else
+            throw std::runtime_error("Please provide valid numeric positive arguments.");
+    }
+}
+
+// print the sequence of any container with operator[] (vector, deque)
+template <typename Container>
+void PmergeMe::printSequence(const std::string& label, const Container& seq) 
+{
+    std::cout << label;
+    for (size_t i = 0; i < seq.size(); ++i) {
+        std::cout << seq[i];
+        if (i < seq.size() - 1) std::cout << " ";
+    }
+    std::cout << std::endl;
+}
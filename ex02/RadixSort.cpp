@@ -0,0 +1,53 @@
+#include "RadixSort.hpp"
+
+void RadixSort::sort(std::vector<unsigned int>& data)
+{
+    std::vector<unsigned int> buffer;
+    sort(data, buffer);
+}
+
+// the buffer is resized to data.size(), passing the same buffer again avoids the allocation
+void RadixSort::sort(std::vector<unsigned int>& data, std::vector<unsigned int>& buffer)
+{
+    size_t n = data.size();
+    if (n <= 1)
+        return;
+    buffer.resize(n);
+
+    // Step 1: histograms of all 4 digits in one pass
+    size_t count[4][256] = {{0}};
+    for (size_t i = 0; i < n; ++i) {
+        unsigned int key = data[i];
+        ++count[0][key & 0xff];
+        ++count[1][(key >> 8) & 0xff];
+        ++count[2][(key >> 16) & 0xff];
+        ++count[3][key >> 24];
+    }
+
+    // Step 2: one stable scatter per digit, lowest digit first
+    for (unsigned int digit = 0; digit < 4; ++digit)
+    {
+        unsigned int shift = digit * 8;
+        size_t* offset = count[digit];
+        if (offset[(data[0] >> shift) & 0xff] == n) // every key has the same digit
+            continue;
+
+        // prefix sums -> first output position of every digit
+        size_t pos = 0;
+        for (size_t d = 0; d < 256; ++d) {
+            size_t c = offset[d];
+            offset[d] = pos;
+            pos += c;
+        }
+        const unsigned int* in = &data[0];
+        unsigned int* out = &buffer[0];
+        for (size_t i = 0; i < n; ++i) {
+            if (i + PREFETCH_DISTANCE < n) {
+                unsigned int ahead = in[i + PREFETCH_DISTANCE];
+                __builtin_prefetch(&out[offset[(ahead >> shift) & 0xff]], 1);
+            }
+            out[offset[(in[i] >> shift) & 0xff]++] = in[i];
+        }
+        data.swap(buffer);
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef RADIXSORT_HPP
+#define RADIXSORT_HPP
+
+#include <vector>
+#include <cstddef>
+
+/*
+LSD radix sort for unsigned int keys:
+
+4 passes with 8-bit digits, every pass scatters the keys into a buffer of the same size
+(stable, so the order of the lower digits is kept). No comparisons at all, the cost is
+memory traffic -> only usable when the order is the natural order of the keys.
+
+Cache-conscious details:
+- the histograms of all 4 digits are built in a single read pass (not one pass per digit)
+- a pass is skipped when every key has the same digit (e.g. the upper byte of small numbers)
+- the scatter prefetches the keys PREFETCH_DISTANCE elements ahead and the output slot they
+  will be written to, so the 256 write streams do not stall on cache misses
+*/
+
+class RadixSort
+{
+private:
+    static const size_t PREFETCH_DISTANCE = 16;
+
+    RadixSort();
+
+public:
+    static void sort(std::vector<unsigned int>& data);
+    static void sort(std::vector<unsigned int>& data, std::vector<unsigned int>& buffer);
+};
+
+#endif
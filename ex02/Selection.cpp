@@ -0,0 +1,208 @@
+#include "Selection.hpp"
+#include <cmath>
+
+// Constructor
+Selection::Selection() : comparisons(0) {}
+
+// Destructor
+Selection::~Selection() {}
+
+unsigned long Selection::comparisonCount() const
+{
+    return comparisons + engine.counter().count();
+}
+
+void Selection::resetCounter()
+{
+    comparisons = 0;
+    engine.resetCounter();
+}
+
+bool Selection::less(unsigned int a, unsigned int b)
+{
+    ++comparisons;
+    return a < b;
+}
+
+// sorts data[first, last) with the Ford-Johnson engine
+void Selection::sortRange(std::vector<unsigned int>& data, size_t first, size_t last)
+{
+    buffer.assign(data.begin() + first, data.begin() + last);
+    engine.sort(buffer);
+    std::copy(buffer.begin(), buffer.end(), data.begin() + first);
+}
+
+// true if data[first, last) holds a single value, one comparison per element:
+// data[last - 1] <= data[first] and no step down in between (a sorted range fails at once)
+bool Selection::isConstant(const std::vector<unsigned int>& data, size_t first, size_t last)
+{
+    if (less(data[first], data[last - 1]))
+        return false;
+    for (size_t i = first + 1; i < last; ++i) {
+        if (less(data[i], data[i - 1]))
+            return false;
+    }
+    return true;
+}
+
+/*
+checks if the sample between the pivots u = sample[lowIndex] and v = sample[highIndex] holds
+only copies of u and v, and moves the copies of u to the front of that window:
+returns b with sample[0, b) <= u and sample[b, s) >= v, or 0 if some value lies strictly between
+*/
+size_t Selection::splitTwoValues(std::vector<unsigned int>& sample, size_t lowIndex, size_t highIndex)
+{
+    unsigned int u = sample[lowIndex];
+    unsigned int v = sample[highIndex];
+    size_t boundary = lowIndex + 1;
+    for (size_t i = lowIndex + 1; i < highIndex; ++i)
+    {
+        if (!less(u, sample[i]))
+            std::swap(sample[i], sample[boundary++]);
+        else if (less(sample[i], v))
+            return 0;
+    }
+    return boundary;
+}
+
+// puts the value of rank k at data[k], nothing bigger in front of it, nothing smaller behind it
+void Selection::nthElement(std::vector<unsigned int>& data, size_t k)
+{
+    if (k < data.size())
+        select(data, 0, data.size(), k);
+}
+
+// selects rank k in data[first, last), returns where the sorted range around k starts
+// (everything in front of it is smaller)
+size_t Selection::select(std::vector<unsigned int>& data, size_t first, size_t last, size_t k)
+{
+    std::vector<unsigned int> pivots;
+    std::vector<unsigned int> low;
+    std::vector<unsigned int> middle;
+    std::vector<unsigned int> high;
+
+    while (last - first > SMALL_RANGE)
+    {
+        size_t n = last - first;
+        size_t rank = k - first;
+
+        // Step 1: evenly spaced sample (no comparison is needed to take it)
+        double z = std::log(static_cast<double>(n));
+        size_t s = std::min(static_cast<size_t>(2 * std::exp(2 * z / 3)), n / 4);
+        size_t stride = n / s;
+        pivots.clear();
+        for (size_t i = 0; i < s; ++i)
+            pivots.push_back(data[first + i * stride]);
+
+        // Step 2: pivots around the expected sample rank of k, selected inside the sample
+        double gap = 0.25 * std::sqrt(z * s * (n - s) / n); // ~1.9 standard deviations of the sample rank
+        double center = static_cast<double>(rank) * s / n;
+        size_t lowIndex = center - gap > 0 ? static_cast<size_t>(center - gap) : 0;
+        size_t highIndex = center + gap < s - 1 ? static_cast<size_t>(center + gap) : s - 1;
+        select(pivots, 0, s, highIndex);
+        if (lowIndex < highIndex)
+            select(pivots, 0, highIndex, lowIndex);
+        unsigned int u = pivots[lowIndex];
+        unsigned int v = pivots[highIndex];
+        bool equalPivots = lowIndex == highIndex || !less(u, v);
+        if (equalPivots && isConstant(data, first, last))
+            return first;
+        // the sample around k holds only u and v: [<= u][> u] instead of the three-way split
+        size_t twoValueBoundary = 0;
+        if (!equalPivots && highIndex - lowIndex >= TWO_VALUE_WINDOW)
+            twoValueBoundary = splitTwoValues(pivots, lowIndex, highIndex);
+
+        // Step 3: three-way split, the sample is placed without comparisons
+        bool upperFirst = rank < n / 2;
+        if (twoValueBoundary > 0) {
+            low.assign(pivots.begin(), pivots.begin() + twoValueBoundary);
+            middle.clear();
+            high.assign(pivots.begin() + twoValueBoundary, pivots.end());
+        } else {
+            low.assign(pivots.begin(), pivots.begin() + lowIndex);
+            middle.assign(pivots.begin() + lowIndex, pivots.begin() + highIndex + 1);
+            high.assign(pivots.begin() + highIndex + 1, pivots.end());
+        }
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (i % stride == 0 && i / stride < s) // sample element, already placed
+                continue;
+            unsigned int value = data[first + i];
+            if (twoValueBoundary > 0) {
+                if (less(u, value))
+                    high.push_back(value);
+                else
+                    low.push_back(value);
+            } else if (upperFirst) {
+                if (less(v, value))
+                    high.push_back(value);
+                else if (less(value, u))
+                    low.push_back(value);
+                else
+                    middle.push_back(value);
+            } else {
+                if (less(value, u))
+                    low.push_back(value);
+                else if (less(v, value))
+                    high.push_back(value);
+                else
+                    middle.push_back(value);
+            }
+        }
+
+        // Step 4: [low][middle][high], continue with the part that holds k
+        std::vector<unsigned int>::iterator out = data.begin() + first;
+        out = std::copy(low.begin(), low.end(), out);
+        out = std::copy(middle.begin(), middle.end(), out);
+        std::copy(high.begin(), high.end(), out);
+
+        size_t newFirst = first;
+        size_t newLast = first + low.size();
+        if (rank >= low.size() + middle.size()) {
+            newFirst = first + low.size() + middle.size();
+            newLast = last;
+        } else if (rank >= low.size()) {
+            newFirst = first + low.size();
+            newLast = newFirst + middle.size();
+            if (equalPivots) // the middle holds only copies of u, already in order
+                return newFirst;
+        }
+        if (newLast - newFirst == n)
+        {
+            // no progress: every element lies in [u, v] with u < v, split off the copies of u
+            low.clear();
+            high.clear();
+            for (size_t i = first; i < last; ++i)
+            {
+                if (less(u, data[i]))
+                    high.push_back(data[i]);
+                else
+                    low.push_back(data[i]);
+            }
+            std::copy(high.begin(), high.end(), std::copy(low.begin(), low.end(), data.begin() + first));
+            if (rank < low.size())
+                return first;
+            newFirst = first + low.size();
+        }
+        first = newFirst;
+        last = newLast;
+    }
+    sortRange(data, first, last);
+    return first;
+}
+
+// the k smallest values in ascending order at the front, the rest in unspecified order
+void Selection::topK(std::vector<unsigned int>& data, size_t k)
+{
+    if (k == 0)
+        return;
+    if (k >= data.size()) {
+        sortRange(data, 0, data.size());
+        return;
+    }
+    // [sortedFrom, k) is sorted by the selection, everything in front of it is smaller
+    size_t sortedFrom = select(data, 0, data.size(), k - 1);
+    if (sortedFrom > 1 && isConstant(data, 0, sortedFrom)) // duplicates: often a single value in front
+        return;
+    sortRange(data, 0, sortedFrom);
+}
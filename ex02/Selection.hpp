@@ -0,0 +1,73 @@
+#ifndef SELECTION_HPP
+#define SELECTION_HPP
+
+#include <vector>
+#include <cstddef>
+#include "FordJohnson.hpp"
+
+/*
+Selection with few comparisons (nth element, top-k), Floyd-Rivest on top of the Ford-Johnson engine:
+
+nthElement(data, k), same contract as std::nth_element:
+1. s ~ 2 n^(2/3) evenly spaced elements form the sample (at most n / 4)
+2. two pivots u <= v are selected in the sample (recursively, ~1.5 s comparisons) just below
+   and above the expected rank of k, so the k-th value lies between them with high probability
+3. every other element is compared with the pivot on the far side of k first:
+       k < n/2: most elements are > v, one comparison with v settles them
+       else:    most elements are < u, one comparison with u settles them
+   -> about n + min(k, n - k) comparisons, the expected optimum of Floyd and Rivest
+   (sample elements need no comparison, their side is known from the sort)
+4. the range is rearranged to [< u][u .. v][> v], only the part that holds k is continued
+Ranges of at most SMALL_RANGE elements are sorted by the Ford-Johnson engine, so the last range
+around k comes out sorted.
+
+Duplicates (few distinct values) never fall back to sorting:
+- u == v: a range that holds nothing but u is done after one comparison per element, otherwise
+  the middle part is exactly the values equal to u, and if k is in it the selection is done
+- u < v and the sample around k holds only u and v: one comparison with u splits the range
+  into [<= u][> u], both parts are smaller (u and v are in different parts)
+- u < v and every element lies in [u, v] (no progress): the ones equal to u are split off
+  with one comparison each
+-> about 1.5 n to 2 n comparisons for two or four distinct values.
+
+topK(data, k), same contract as std::partial_sort(begin, begin + k, end):
+nthElement for the k-th value, then the Ford-Johnson engine sorts the k smallest
+(the last range of the selection is already sorted and is skipped, so is a front part that
+holds a single value)
+-> n + min(k, n - k) + k log2(k) comparisons.
+
+All comparisons (own and the engine's) are counted, comparisonCount() returns the total.
+*/
+
+class Selection
+{
+private:
+    typedef FordJohnson<std::vector<unsigned int>, IdentityKey<unsigned int>, std::less<unsigned int>, ComparisonCount> Engine;
+
+    static const size_t SMALL_RANGE = 64;
+    static const size_t TWO_VALUE_WINDOW = 8; // sample elements between u and v needed to trust that only u and v occur
+
+    Engine engine;
+    unsigned long comparisons; // own comparisons, the engine counts its own
+    std::vector<unsigned int> buffer; // ranges sorted by the engine
+
+    Selection(const Selection& other);
+    Selection& operator=(const Selection& other);
+
+    bool less(unsigned int a, unsigned int b);
+    void sortRange(std::vector<unsigned int>& data, size_t first, size_t last);
+    bool isConstant(const std::vector<unsigned int>& data, size_t first, size_t last);
+    size_t splitTwoValues(std::vector<unsigned int>& sample, size_t lowIndex, size_t highIndex);
+    size_t select(std::vector<unsigned int>& data, size_t first, size_t last, size_t k);
+
+public:
+    Selection();
+    ~Selection();
+
+    void nthElement(std::vector<unsigned int>& data, size_t k);
+    void topK(std::vector<unsigned int>& data, size_t k);
+    unsigned long comparisonCount() const;
+    void resetCounter();
+};
+
+#endif
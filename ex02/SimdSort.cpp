@@ -0,0 +1,129 @@
+#include "SimdSort.hpp"
+#include "RadixSort.hpp"
+#include <algorithm>
+#include <immintrin.h>
+
+namespace
+{
+    /*
+    One step of the bitonic network on 8 lanes:
+    every lane is compared with the lane 'perm' points to, 'maxLanes' has a bit set for
+    every lane that keeps the larger value of its pair (the blend mask must be a constant).
+    */
+    #define BITONIC_STEP(v, p0, p1, p2, p3, p4, p5, p6, p7, maxLanes) \
+        do { \
+            __m256i partner = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(p0, p1, p2, p3, p4, p5, p6, p7)); \
+            v = _mm256_blend_epi32(_mm256_min_epu32(v, partner), _mm256_max_epu32(v, partner), maxLanes); \
+        } while (0)
+
+    // sorts the 8 lanes ascending (bitonic sort: merges of size 2, 4, 8)
+    __attribute__((target("avx2"))) __m256i sort8(__m256i v)
+    {
+        BITONIC_STEP(v, 1, 0, 3, 2, 5, 4, 7, 6, 0x66);
+        BITONIC_STEP(v, 2, 3, 0, 1, 6, 7, 4, 5, 0x3C);
+        BITONIC_STEP(v, 1, 0, 3, 2, 5, 4, 7, 6, 0x5A);
+        BITONIC_STEP(v, 4, 5, 6, 7, 0, 1, 2, 3, 0xF0);
+        BITONIC_STEP(v, 2, 3, 0, 1, 6, 7, 4, 5, 0xCC);
+        BITONIC_STEP(v, 1, 0, 3, 2, 5, 4, 7, 6, 0xAA);
+        return v;
+    }
+
+    // sorts the 8 lanes of a bitonic sequence ascending (half cleaners of size 8, 4, 2)
+    __attribute__((target("avx2"))) __m256i bitonicMerge8(__m256i v)
+    {
+        BITONIC_STEP(v, 4, 5, 6, 7, 0, 1, 2, 3, 0xF0);
+        BITONIC_STEP(v, 2, 3, 0, 1, 6, 7, 4, 5, 0xCC);
+        BITONIC_STEP(v, 1, 0, 3, 2, 5, 4, 7, 6, 0xAA);
+        return v;
+    }
+
+    #undef BITONIC_STEP
+}
+
+bool SimdSort::hasAvx2()
+{
+    return __builtin_cpu_supports("avx2");
+}
+
+// which path sort() takes for n keys, for the reports
+const char* SimdSort::pathName(size_t n)
+{
+    if (n >= RADIX_MIN_SIZE)
+        return "radix";
+    return hasAvx2() ? "AVX2 bitonic" : "scalar blocks";
+}
+
+/*
+16 keys in two registers a and b:
+    sort a and b separately                              a = 1 4 6 9 ...   b = 0 2 3 8 ...
+    reverse b -> a + reversed b is a bitonic sequence
+    min/max of a and reversed b: every min <= every max, both halves are bitonic
+    sort both halves with the half cleaners              -> low 8 keys in a, high 8 keys in b
+*/
+__attribute__((target("avx2"))) void SimdSort::sortBlocksAvx2(unsigned int* data, size_t numBlocks)
+{
+    const __m256i reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+
+    for (size_t blk = 0; blk < numBlocks; ++blk)
+    {
+        __m256i* block = reinterpret_cast<__m256i*>(data + blk * BLOCK_SIZE);
+        __m256i a = sort8(_mm256_loadu_si256(block));
+        __m256i b = _mm256_permutevar8x32_epi32(sort8(_mm256_loadu_si256(block + 1)), reverse);
+        __m256i low = bitonicMerge8(_mm256_min_epu32(a, b));
+        __m256i high = bitonicMerge8(_mm256_max_epu32(a, b));
+        _mm256_storeu_si256(block, low);
+        _mm256_storeu_si256(block + 1, high);
+    }
+}
+
+void SimdSort::sortBlockScalar(unsigned int* first, unsigned int* last)
+{
+    for (unsigned int* it = first + 1; it < last; ++it) {
+        unsigned int value = *it;
+        unsigned int* pos = it;
+        while (pos > first && *(pos - 1) > value) {
+            *pos = *(pos - 1);
+            --pos;
+        }
+        *pos = value;
+    }
+}
+
+// bottom-up merge of the sorted blocks, the runs double every pass and alternate between two buffers
+void SimdSort::mergeBlocks(std::vector<unsigned int>& data)
+{
+    size_t n = data.size();
+    std::vector<unsigned int> buffer(n);
+
+    for (size_t run = BLOCK_SIZE; run < n; run *= 2)
+    {
+        for (size_t start = 0; start < n; start += 2 * run)
+        {
+            size_t mid = std::min(start + run, n);
+            size_t end = std::min(start + 2 * run, n);
+            std::merge(data.begin() + start, data.begin() + mid, data.begin() + mid, data.begin() + end,
+                       buffer.begin() + start);
+        }
+        data.swap(buffer);
+    }
+}
+
+void SimdSort::sort(std::vector<unsigned int>& data)
+{
+    if (data.size() <= 1)
+        return;
+    if (data.size() >= RADIX_MIN_SIZE) {
+        RadixSort::sort(data);
+        return;
+    }
+
+    size_t numBlocks = data.size() / BLOCK_SIZE;
+    if (hasAvx2()) {
+        sortBlocksAvx2(&data[0], numBlocks);
+    } else {
+        for (size_t blk = 0; blk < numBlocks; ++blk)
+            sortBlockScalar(&data[blk * BLOCK_SIZE], &data[blk * BLOCK_SIZE] + BLOCK_SIZE);
+    }
+    sortBlockScalar(&data[0] + numBlocks * BLOCK_SIZE, &data[0] + data.size()); // incomplete last block
+    mergeBlocks(data);
+}
@@ -0,0 +1,38 @@
+#ifndef SIMDSORT_HPP
+#define SIMDSORT_HPP
+
+#include <vector>
+#include <cstddef>
+
+/*
+Sort engine for cheap unsigned int keys that uses the vector units of the CPU:
+
+- small inputs (< RADIX_MIN_SIZE): blocks of 16 keys are sorted in two AVX2 registers with a
+  bitonic sorting network (min/max of 8 lanes at once, no branches), then the sorted blocks are
+  merged bottom-up through one buffer
+- large inputs: RadixSort (one histogram pass, prefetching scatter)
+
+AVX2 is compiled with __attribute__((target("avx2"))) only for the network, the rest of the
+program keeps the default instruction set. The CPU is checked at runtime, without AVX2 the
+blocks are sorted by a scalar insertion sort instead.
+*/
+
+class SimdSort
+{
+private:
+    static const size_t BLOCK_SIZE = 16;
+    static const size_t RADIX_MIN_SIZE = 2048;
+
+    SimdSort();
+
+    static void sortBlocksAvx2(unsigned int* data, size_t numBlocks);
+    static void sortBlockScalar(unsigned int* first, unsigned int* last);
+    static void mergeBlocks(std::vector<unsigned int>& data);
+
+public:
+    static bool hasAvx2();
+    static const char* pathName(size_t n);
+    static void sort(std::vector<unsigned int>& data);
+};
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef SMALLSORT_HPP
+#define SMALLSORT_HPP
+
+#include <cstddef>
+#include <cstring>
+
+/*
+Merge-insertion kernels for up to SMALL_SORT_MAX elements:
+
+For a handful of blocks the bookkeeping of an engine round (Jacobsthal sequence, insertion order,
+computeK, restructuring through the scratch arena) costs far more than the comparisons.
+SmallSort<N> is the same algorithm with N fixed at compile time:
+
+- Step 1: compare the N / 2 pairs
+- Step 2: sort the pairs by their winners with SmallSort<N / 2> (the comparator looks through the pairs)
+- Step 3: main chain = sorted winners, the loser of the smallest winner goes in front
+- Step 4: insert the other losers in Jacobsthal groups (3 2) (5 4) (11 10 ... 6), every one
+          only searches the chain in front of its partner, the leftover of odd N the whole chain
+
+The recursion and the groups are template parameters (SmallSortGroups, bounds from Jacobsthal<K>),
+every loop except the binary search has a constant trip count and is unrolled by the compiler.
+The kernels sort element numbers (unsigned char), the caller's comparator compares two numbers,
+so the engine sorts single elements and whole blocks (by their last element) with the same code.
+
+Comparisons in the worst case are those of Ford-Johnson: 0 1 3 5 7 10 13 16 19 22 26 30 34 38 42 46
+for N = 1 ... 16, the proven minimum for N <= 15.
+*/
+
+static const size_t SMALL_SORT_MAX = 16;
+
+// J(K) = J(K - 1) + 2 J(K - 2): 0 1 1 3 5 11 21 43 ..., computed by the compiler
+template <unsigned int K>
+struct Jacobsthal
+{
+    static const unsigned long value = Jacobsthal<K - 1>::value + 2 * Jacobsthal<K - 2>::value;
+};
+
+template <>
+struct Jacobsthal<0>
+{
+    static const unsigned long value = 0;
+};
+
+template <>
+struct Jacobsthal<1>
+{
+    static const unsigned long value = 1;
+};
+
+// inserts the pending losers J(K + 1), ..., J(K) + 1 (capped at PENDING), then the next group
+template <size_t PENDING, unsigned int K, bool DONE = (Jacobsthal<K>::value >= PENDING)>
+struct SmallSortGroups
+{
+    template <typename Less>
+    static void insert(unsigned char* chain, size_t& length, const unsigned char* pending,
+                       const unsigned char* partner, Less& less);
+};
+
+template <size_t PENDING, unsigned int K>
+struct SmallSortGroups<PENDING, K, true>
+{
+    template <typename Less>
+    static void insert(unsigned char*, size_t&, const unsigned char*, const unsigned char*, Less&) {}
+};
+
+template <size_t N>
+struct SmallSort
+{
+    // sorts the element numbers order[0 .. N) with less(a, b) on two element numbers
+    template <typename Less>
+    static void sort(unsigned char* order, Less& less);
+};
+
+template <>
+struct SmallSort<0>
+{
+    template <typename Less>
+    static void sort(unsigned char*, Less&) {}
+};
+
+template <>
+struct SmallSort<1>
+{
+    template <typename Less>
+    static void sort(unsigned char*, Less&) {}
+};
+
+// picks the kernel for n <= SMALL_SORT_MAX at run time
+template <typename Less>
+void smallSort(unsigned char* order, size_t n, Less& less);
+
+#include "SmallSort.tpp"
+
+#endif
@@ -0,0 +1,121 @@
+// template implementation of the small sort kernels, included by SmallSort.hpp
+
+// element number that marks the leftover loser of odd N, it has no partner in the chain
+static const unsigned char SMALL_SORT_NO_PARTNER = 0xff;
+
+// compares two pairs by their winners, the recursion of Step 2 sorts pair numbers
+template <typename Less>
+struct SmallSortByWinner
+{
+    Less& less;
+    const unsigned char* winner;
+
+    SmallSortByWinner(Less& less, const unsigned char* winner) : less(less), winner(winner) {}
+    bool operator()(unsigned char a, unsigned char b) { return less(winner[a], winner[b]); }
+};
+
+// binary insertion in front of the partner (the whole chain without one), at most 16 elements are shifted
+template <typename Less>
+void smallSortInsert(unsigned char* chain, size_t& length, unsigned char value, unsigned char partner, Less& less)
+{
+    size_t low = 0;
+    size_t high = length;
+
+    if (partner != SMALL_SORT_NO_PARTNER) {
+        high = 0;
+        while (chain[high] != partner) // no comparison, only element numbers
+            ++high;
+    }
+    while (low < high)
+    {
+        size_t mid = (low + high) / 2;
+        if (less(value, chain[mid]))
+            high = mid;
+        else
+            low = mid + 1;
+    }
+    std::memmove(chain + low + 1, chain + low, length - low);
+    chain[low] = value;
+    ++length;
+}
+
+template <size_t PENDING, unsigned int K, bool DONE>
+template <typename Less>
+void SmallSortGroups<PENDING, K, DONE>::insert(unsigned char* chain, size_t& length, const unsigned char* pending,
+                                               const unsigned char* partner, Less& less)
+{
+    const size_t groupEnd = Jacobsthal<K + 1>::value < PENDING ? Jacobsthal<K + 1>::value : PENDING;
+
+    for (size_t j = groupEnd; j > Jacobsthal<K>::value; --j) // descending inside the group
+        smallSortInsert(chain, length, pending[j - 1], partner[j - 1], less);
+    SmallSortGroups<PENDING, K + 1>::insert(chain, length, pending, partner, less);
+}
+
+template <size_t N>
+template <typename Less>
+void SmallSort<N>::sort(unsigned char* order, Less& less)
+{
+    enum { PAIRS = N / 2, PENDING = N - N / 2 };
+    unsigned char winner[PAIRS];
+    unsigned char loser[PENDING];
+    unsigned char pairOrder[PAIRS];
+
+    // Step 1: compare the pairs
+    for (size_t i = 0; i < PAIRS; ++i)
+    {
+        bool swapped = less(order[2 * i + 1], order[2 * i]);
+        winner[i] = swapped ? order[2 * i] : order[2 * i + 1];
+        loser[i] = swapped ? order[2 * i + 1] : order[2 * i];
+        pairOrder[i] = static_cast<unsigned char>(i);
+    }
+
+    // Step 2: sort the pairs by their winners
+    SmallSortByWinner<Less> byWinner(less, winner);
+    SmallSort<PAIRS>::sort(pairOrder, byWinner);
+
+    // Step 3: main chain, pending losers in the order of their partners
+    unsigned char chain[N];
+    unsigned char pending[PENDING];
+    unsigned char partner[PENDING];
+    size_t length = PAIRS + 1;
+
+    chain[0] = loser[pairOrder[0]];
+    for (size_t i = 0; i < PAIRS; ++i)
+    {
+        chain[i + 1] = winner[pairOrder[i]];
+        pending[i] = loser[pairOrder[i]];
+        partner[i] = winner[pairOrder[i]];
+    }
+    if (N % 2 != 0) {
+        pending[PENDING - 1] = order[N - 1];
+        partner[PENDING - 1] = SMALL_SORT_NO_PARTNER;
+    }
+
+    // Step 4: the first group is the loser already in front, the next one is (3 2)
+    SmallSortGroups<PENDING, 2>::insert(chain, length, pending, partner, less);
+    std::memcpy(order, chain, N);
+}
+
+template <typename Less>
+void smallSort(unsigned char* order, size_t n, Less& less)
+{
+    switch (n)
+    {
+        case 2: SmallSort<2>::sort(order, less); break;
+        case 3: SmallSort<3>::sort(order, less); break;
+        case 4: SmallSort<4>::sort(order, less); break;
+        case 5: SmallSort<5>::sort(order, less); break;
+        case 6: SmallSort<6>::sort(order, less); break;
+        case 7: SmallSort<7>::sort(order, less); break;
+        case 8: SmallSort<8>::sort(order, less); break;
+        case 9: SmallSort<9>::sort(order, less); break;
+        case 10: SmallSort<10>::sort(order, less); break;
+        case 11: SmallSort<11>::sort(order, less); break;
+        case 12: SmallSort<12>::sort(order, less); break;
+        case 13: SmallSort<13>::sort(order, less); break;
+        case 14: SmallSort<14>::sort(order, less); break;
+        case 15: SmallSort<15>::sort(order, less); break;
+        case 16: SmallSort<16>::sort(order, less); break;
+        default: break; // 0 and 1 elements are sorted
+    }
+}
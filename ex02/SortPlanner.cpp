@@ -0,0 +1,142 @@
+#include "SortPlanner.hpp"
+#include "PmergeMe.hpp"
+#include <sstream>
+#include <cmath>
+
+namespace
+{
+    // std::less that counts its calls, copies share the counter
+    struct CountingLess
+    {
+        unsigned long* calls;
+        explicit CountingLess(unsigned long* calls) : calls(calls) {}
+        bool operator()(unsigned int a, unsigned int b) const { ++*calls; return a < b; }
+    };
+
+    double nLogN(size_t n)
+    {
+        return n < 2 ? 1 : n * std::log(static_cast<double>(n)) / std::log(2.0);
+    }
+}
+
+// Constructor, typical values until calibrate() runs
+SortPlanner::SortPlanner()
+    : fjMoveNs(6.0), fjCompares(0.95), introMoveNs(1.2), introCompares(1.1), radixNs(2.0), plainCompareNs(1.0), comparatorNs(0) {}
+
+// Destructor
+SortPlanner::~SortPlanner() {}
+
+double SortPlanner::now()
+{
+    return PmergeMe::monotonicSeconds();
+}
+
+/*
+Sorts the same random sample with every engine and derives the constants of the model:
+    xxxMoveNs = time / (n*log2(n))        (the plain comparator is part of it)
+    xxxCompares = comparisons / (n*log2(n))
+The plain comparison cost is measured too, so a comparator cost given later only counts
+what it costs on top of comparing two unsigned ints.
+*/
+void SortPlanner::calibrate(size_t sampleSize)
+{
+    if (sampleSize < 2)
+        sampleSize = 2;
+    std::vector<unsigned int> sample = PmergeMe::randomSequence(sampleSize, 12345);
+    double scale = nLogN(sampleSize);
+
+    std::vector<unsigned int> data = sample;
+    FordJohnson<std::vector<unsigned int>, IdentityKey<unsigned int>, std::less<unsigned int>, ComparisonCount> engine;
+    double start = now();
+    engine.sort(data);
+    fjMoveNs = (now() - start) * 1e9 / scale;
+    fjCompares = engine.counter().count() / scale;
+
+    data = sample;
+    unsigned long calls = 0;
+    start = now();
+    std::sort(data.begin(), data.end(), CountingLess(&calls));
+    introMoveNs = (now() - start) * 1e9 / scale;
+    introCompares = calls / scale;
+
+    data = sample;
+    std::vector<unsigned int> buffer(sampleSize);
+    start = now();
+    RadixSort::sort(data, buffer);
+    radixNs = (now() - start) * 1e9 / sampleSize;
+
+    // the sorts above already paid the plain comparison
+    plainCompareNs = measureComparatorCost(std::less<unsigned int>(), sample);
+}
+
+// extra cost of one comparison in ns (on top of a plain unsigned int comparison)
+void SortPlanner::setComparatorCost(double ns)
+{
+    comparatorNs = ns > 0 ? ns : 0;
+}
+
+double SortPlanner::comparatorCost() const
+{
+    return comparatorNs;
+}
+
+// cost of a plain unsigned int comparison, subtract it from measureComparatorCost() of a comparator
+double SortPlanner::plainComparatorCost() const
+{
+    return plainCompareNs;
+}
+
+// predicted time of every engine for n elements, the cheapest eligible one wins
+SortPlanner::Plan SortPlanner::choose(size_t n, bool naturalOrder) const
+{
+    Plan plan;
+    double scale = nLogN(n);
+
+    plan.eligible[MERGE_INSERTION] = true;
+    plan.eligible[INTROSORT] = true;
+    plan.eligible[RADIX] = naturalOrder;
+    plan.predictedMs[MERGE_INSERTION] = (scale * fjMoveNs + scale * fjCompares * comparatorNs) / 1e6;
+    plan.predictedMs[INTROSORT] = (scale * introMoveNs + scale * introCompares * comparatorNs) / 1e6;
+    plan.predictedMs[RADIX] = n * radixNs / 1e6;
+
+    plan.engine = INTROSORT;
+    for (int e = 0; e < ENGINE_COUNT; ++e) {
+        if (plan.eligible[e] && plan.predictedMs[e] < plan.predictedMs[plan.engine])
+            plan.engine = static_cast<Engine>(e);
+    }
+
+    std::ostringstream reason;
+    if (plan.engine == RADIX)
+        reason << "keys are plain unsigned ints in natural order, " << "4 passes over memory are cheaper than "
+               << static_cast<unsigned long>(scale * introCompares) << " comparisons";
+    else if (plan.engine == MERGE_INSERTION)
+        reason << "a comparison costs " << comparatorNs << " ns, merge-insertion saves "
+               << static_cast<long>(scale * (introCompares - fjCompares)) << " comparisons and that outweighs its data movement";
+    else
+        reason << "a comparison costs " << comparatorNs << " ns, too cheap for the data movement of merge-insertion to pay off";
+    if (!naturalOrder)
+        reason << " (radix not eligible: custom order)";
+    plan.reason = reason.str();
+    return plan;
+}
+
+// number of CostlyLess spins that cost about 'ns' nanoseconds on this machine
+unsigned int SortPlanner::spinsForCost(double ns)
+{
+    const unsigned int probeSpins = 1000;
+    std::vector<unsigned int> sample = PmergeMe::randomSequence(1024, 1);
+    double probeNs = measureComparatorCost(CostlyLess(probeSpins), sample)
+        - measureComparatorCost(CostlyLess(0), sample);
+    if (ns <= 0 || probeNs <= 0)
+        return 0;
+    return static_cast<unsigned int>(ns / probeNs * probeSpins + 0.5);
+}
+
+const char* SortPlanner::engineName(Engine engine)
+{
+    if (engine == MERGE_INSERTION)
+        return "merge-insertion";
+    if (engine == INTROSORT)
+        return "introsort";
+    return "radix";
+}
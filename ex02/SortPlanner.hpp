@@ -0,0 +1,94 @@
+#ifndef SORTPLANNER_HPP
+#define SORTPLANNER_HPP
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstddef>
+#include "FordJohnson.hpp"
+#include "RadixSort.hpp"
+
+/*
+Picks the sort engine for a sequence of unsigned int from a cost model:
+
+Ford-Johnson makes the fewest comparisons, but it moves a lot of memory around.
+With a cheap comparator (plain unsigned int) that is far slower than a cache-friendly sort,
+with an expensive comparator the saved comparisons win. The model per engine:
+
+    merge-insertion:  n*log2(n) * fjMoveNs     + fjCompares(n)    * comparatorNs
+    introsort:        n*log2(n) * introMoveNs  + introCompares(n) * comparatorNs     (std::sort)
+    radix:            n * radixNs                                                    (no comparisons)
+
+- xxxMoveNs / radixNs: time per element without comparator cost, measured by calibrate()
+- xxxCompares(n):      comparisons per n*log2(n), counted during calibrate()
+- comparatorNs:        extra cost of one comparison, given or measured (measureComparatorCost)
+- radix only sorts in the natural order of the keys, it is not eligible for a custom comparator
+
+Without calibrate() the constants are typical values of a desktop machine.
+*/
+
+// std::less with an adjustable cost: busy-waits 'spins' iterations before comparing
+// stands in for an expensive comparator (string keys, records, ...) in the benchmarks
+struct CostlyLess
+{
+    unsigned int spins;
+
+    explicit CostlyLess(unsigned int spins = 0) : spins(spins) {}
+    bool operator()(unsigned int a, unsigned int b) const
+    {
+        volatile unsigned int wait = 0;
+        for (unsigned int i = 0; i < spins; ++i)
+            wait = wait + 1;
+        return a < b;
+    }
+};
+
+class SortPlanner
+{
+public:
+    enum Engine { MERGE_INSERTION, INTROSORT, RADIX, ENGINE_COUNT };
+
+    struct Plan
+    {
+        Engine engine;
+        bool eligible[ENGINE_COUNT];
+        double predictedMs[ENGINE_COUNT];
+        std::string reason;
+    };
+
+private:
+    double fjMoveNs;
+    double fjCompares;
+    double introMoveNs;
+    double introCompares;
+    double radixNs;
+    double plainCompareNs;
+    double comparatorNs;
+
+    static double now();
+
+public:
+    SortPlanner();
+    ~SortPlanner();
+
+    void calibrate(size_t sampleSize = 1 << 15);
+    void setComparatorCost(double ns);
+    double comparatorCost() const;
+    double plainComparatorCost() const;
+    Plan choose(size_t n, bool naturalOrder) const;
+
+    // sorts with the engine of the plan, radix ignores the comparator (natural order only)
+    template <typename Compare>
+    void sort(std::vector<unsigned int>& data, const Plan& plan, const Compare& compare) const;
+
+    // time of one call of the comparator, in ns (includes the cost of a plain comparison)
+    template <typename Compare>
+    static double measureComparatorCost(const Compare& compare, const std::vector<unsigned int>& sample);
+
+    static unsigned int spinsForCost(double ns);
+    static const char* engineName(Engine engine);
+};
+
+#include "SortPlanner.tpp"
+
+#endif
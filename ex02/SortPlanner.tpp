@@ -0,0 +1,34 @@
+// template implementation of SortPlanner, included by SortPlanner.hpp
+
+// calls the comparator on neighbouring elements of the sample for a few milliseconds
+template <typename Compare>
+double SortPlanner::measureComparatorCost(const Compare& compare, const std::vector<unsigned int>& sample)
+{
+    if (sample.size() < 2)
+        return 0;
+
+    volatile size_t sink = 0; // keeps the calls from being optimized away
+    size_t calls = 0;
+    double start = now();
+    double elapsed = 0;
+    do {
+        for (size_t i = 0; i + 1 < sample.size(); ++i)
+            sink = sink + compare(sample[i], sample[i + 1]);
+        calls += sample.size() - 1;
+        elapsed = now() - start;
+    } while (elapsed < 0.005);
+    return elapsed * 1e9 / calls;
+}
+
+template <typename Compare>
+void SortPlanner::sort(std::vector<unsigned int>& data, const Plan& plan, const Compare& compare) const
+{
+    if (plan.engine == RADIX) {
+        RadixSort::sort(data);
+    } else if (plan.engine == INTROSORT) {
+        std::sort(data.begin(), data.end(), compare);
+    } else {
+        FordJohnson<std::vector<unsigned int>, IdentityKey<unsigned int>, Compare> engine(IdentityKey<unsigned int>(), compare);
+        engine.sort(data);
+    }
+}
@@ -0,0 +1,152 @@
+#ifndef TIEREDVECTOR_HPP
+#define TIEREDVECTOR_HPP
+
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <cstddef>
+
+/*
+Tiered vector: random access container with O(sqrt(n)) inserts in the middle
+
+std::vector moves every element behind an insertion point, std::deque is not better
+in the middle. The tiered vector stores the elements in chunks of C slots (C a power
+of two close to sqrt(n)), every chunk is a ring buffer with its own head:
+
+    element i  ->  chunk i / C, slot (head[chunk] + i) % C
+
+- operator[]          two shifts and a mask, the chunks are one contiguous array
+- moveBlock(p, s, e)  moves the elements [s, e) to position p (p < s), the elements in between
+                      move back by e - s. A chunk in between only turns its ring by e - s and
+                      takes e - s elements from the chunk before, O(e - s) instead of O(C)
+                      -> one element: O(n / C + C) = O(sqrt(n)) instead of O(n)
+
+- insert(p, value)     push_back and a moveBlock of one element, O(sqrt(n))
+
+All chunks except the last one are full, so positions never have to be searched.
+push_back adds a chunk when the last one is full; when n outgrows 4 * C^2 the elements
+are spread over chunks of twice the size, so C stays close to sqrt(n) (amortized O(1)).
+fjMoveBlock (FordJohnson.hpp) calls moveBlock, so the rotate backend of the Ford-Johnson
+engine inserts its pending blocks with it.
+*/
+
+template <typename Value, typename Owner, typename Ref, typename Ptr>
+class TieredIterator : public std::iterator<std::random_access_iterator_tag, Value, std::ptrdiff_t, Ptr, Ref>
+{
+private:
+    Owner* owner;
+    size_t index;
+
+public:
+    TieredIterator() : owner(NULL), index(0) {}
+    TieredIterator(Owner* owner, size_t index) : owner(owner), index(index) {}
+    // iterator -> const_iterator
+    template <typename O, typename R, typename P>
+    TieredIterator(const TieredIterator<Value, O, R, P>& other) : owner(other.container()), index(other.position()) {}
+
+    Owner* container() const { return owner; }
+    size_t position() const { return index; }
+
+    Ref operator*() const { return (*owner)[index]; }
+    Ptr operator->() const { return &(*owner)[index]; }
+    Ref operator[](std::ptrdiff_t n) const { return (*owner)[index + n]; }
+
+    TieredIterator& operator++() { ++index; return *this; }
+    TieredIterator& operator--() { --index; return *this; }
+    TieredIterator operator++(int) { TieredIterator old(*this); ++index; return old; }
+    TieredIterator operator--(int) { TieredIterator old(*this); --index; return old; }
+    TieredIterator& operator+=(std::ptrdiff_t n) { index += n; return *this; }
+    TieredIterator& operator-=(std::ptrdiff_t n) { index -= n; return *this; }
+    TieredIterator operator+(std::ptrdiff_t n) const { return TieredIterator(owner, index + n); }
+    TieredIterator operator-(std::ptrdiff_t n) const { return TieredIterator(owner, index - n); }
+    std::ptrdiff_t operator-(const TieredIterator& other) const
+    {
+        return static_cast<std::ptrdiff_t>(index) - static_cast<std::ptrdiff_t>(other.index);
+    }
+
+    bool operator==(const TieredIterator& other) const { return index == other.index; }
+    bool operator!=(const TieredIterator& other) const { return index != other.index; }
+    bool operator<(const TieredIterator& other) const { return index < other.index; }
+    bool operator>(const TieredIterator& other) const { return index > other.index; }
+    bool operator<=(const TieredIterator& other) const { return index <= other.index; }
+    bool operator>=(const TieredIterator& other) const { return index >= other.index; }
+};
+
+template <typename Value, typename Owner, typename Ref, typename Ptr>
+TieredIterator<Value, Owner, Ref, Ptr> operator+(std::ptrdiff_t n, const TieredIterator<Value, Owner, Ref, Ptr>& it)
+{
+    return it + n;
+}
+
+template <typename T>
+class TieredVector
+{
+public:
+    typedef T value_type;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef TieredIterator<T, TieredVector, T&, T*> iterator;
+    typedef TieredIterator<T, const TieredVector, const T&, const T*> const_iterator;
+
+    // chunks are never smaller than this, tiny inputs do not need the rings
+    static const size_t MIN_CHUNK_SHIFT = 4;
+
+    TieredVector();
+    TieredVector(const TieredVector& other);
+    TieredVector& operator=(const TieredVector& other);
+    ~TieredVector();
+
+    template <typename InputIt>
+    void assign(InputIt first, InputIt last);
+    void clear();
+    void push_back(const T& value);
+    void insert(size_t pos, const T& value);
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t chunkCapacity() const { return mask + 1; }
+
+    reference operator[](size_t i) { return slots[slot(i)]; }
+    const_reference operator[](size_t i) const { return slots[slot(i)]; }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, count); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, count); }
+
+    void moveBlock(size_t insertPos, size_t start, size_t end);
+
+private:
+    std::vector<T> slots;      // chunk c owns slots [c * C, (c + 1) * C)
+    std::vector<size_t> heads; // ring offset of every chunk
+    std::vector<T> moving;     // the block of moveBlock, kept between the calls
+    size_t count;
+    size_t shift;              // C = 1 << shift
+    size_t mask;               // C - 1
+
+    size_t slot(size_t i) const
+    {
+        size_t chunk = i >> shift;
+        return (chunk << shift) | ((heads[chunk] + i) & mask);
+    }
+};
+
+// the rotate backend of FordJohnson inserts pending blocks through the rings
+template <typename T>
+void fjMoveBlock(TieredVector<T>& data, size_t insertPos, size_t start, size_t end)
+{
+    data.moveBlock(insertPos, start, end);
+}
+
+// blocks of a fixed size take the same path, the rings already move them in O(sqrt(n))
+template <size_t N, typename T>
+void fjMoveFixedBlock(TieredVector<T>& data, size_t insertPos, size_t start)
+{
+    data.moveBlock(insertPos, start, start + N);
+}
+
+#include "TieredVector.tpp"
+
+#endif
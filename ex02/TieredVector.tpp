@@ -0,0 +1,121 @@
+// template implementation of TieredVector, included by TieredVector.hpp
+
+// Constructor
+template <typename T>
+TieredVector<T>::TieredVector() : count(0), shift(MIN_CHUNK_SHIFT), mask((1u << MIN_CHUNK_SHIFT) - 1) {}
+
+// Copy constructor
+template <typename T>
+TieredVector<T>::TieredVector(const TieredVector& other)
+    : slots(other.slots), heads(other.heads), count(other.count), shift(other.shift), mask(other.mask) {}
+
+// Copy assignment operator
+template <typename T>
+TieredVector<T>& TieredVector<T>::operator=(const TieredVector& other)
+{
+    if (this != &other) {
+        slots = other.slots;
+        heads = other.heads;
+        count = other.count;
+        shift = other.shift;
+        mask = other.mask;
+    }
+    return *this;
+}
+
+// Destructor
+template <typename T>
+TieredVector<T>::~TieredVector() {}
+
+template <typename T>
+void TieredVector<T>::clear()
+{
+    slots.clear();
+    heads.clear();
+    count = 0;
+}
+
+// replaces the content, the chunk size is chosen for the new size: C = 2^k >= sqrt(n)
+template <typename T>
+template <typename InputIt>
+void TieredVector<T>::assign(InputIt first, InputIt last)
+{
+    std::vector<T> values(first, last);
+
+    count = values.size();
+    shift = MIN_CHUNK_SHIFT;
+    while ((static_cast<size_t>(1) << (2 * shift)) < count)
+        ++shift;
+    mask = (static_cast<size_t>(1) << shift) - 1;
+
+    size_t chunks = (count + mask) >> shift;
+    slots.assign(chunks << shift, T());
+    heads.assign(chunks, 0);
+    std::copy(values.begin(), values.end(), slots.begin()); // all heads are 0: slot == index
+}
+
+// appends a value, a full last chunk gets a new (empty) neighbour
+template <typename T>
+void TieredVector<T>::push_back(const T& value)
+{
+    if (count == slots.size() && count >= (static_cast<size_t>(4) << (2 * shift))) {
+        std::vector<T> values(begin(), end());
+        assign(values.begin(), values.end()); // chooses a larger chunk size
+    }
+    if (count == slots.size()) {
+        slots.resize(slots.size() + mask + 1);
+        heads.push_back(0);
+    }
+    // only full chunks are ever turned, the last chunk still has head 0
+    (*this)[count++] = value;
+}
+
+// puts value in front of the element at pos (pos == size() appends)
+template <typename T>
+void TieredVector<T>::insert(size_t pos, const T& value)
+{
+    push_back(value);
+    moveBlock(pos, count - 1, count);
+}
+
+/*
+Moves the elements [start, end) to insertPos (insertPos <= start), same result as
+std::rotate(begin() + insertPos, begin() + start, begin() + end):
+
+    [insertPos ............ start)[start .. end)
+    the block is saved, then every element in between moves back by b = end - start,
+    walking from the last chunk down:
+    - a chunk that is completely inside the range turns its ring by b (O(1)) and copies
+      the b elements in front of it from the previous chunk, which is not touched yet
+    - the partial chunks at both ends are shifted element by element
+    finally the block is copied into the b free positions at insertPos
+*/
+template <typename T>
+void TieredVector<T>::moveBlock(size_t insertPos, size_t start, size_t end)
+{
+    size_t b = end - start;
+    if (insertPos >= start || b == 0)
+        return;
+
+    moving.assign(begin() + start, begin() + end);
+    size_t capacity = mask + 1;
+    size_t lowest = insertPos + b; // lowest destination of the shift
+    size_t pos = end;              // destinations [lowest, pos) still have to be filled
+    while (pos > lowest)
+    {
+        size_t chunkStart = ((pos - 1) >> shift) << shift;
+        if (b < capacity && chunkStart >= lowest && pos == chunkStart + capacity) {
+            size_t chunk = chunkStart >> shift;
+            heads[chunk] = (heads[chunk] - b) & mask;
+            for (size_t i = chunkStart; i < chunkStart + b; ++i)
+                (*this)[i] = (*this)[i - b];
+            pos = chunkStart;
+        } else {
+            size_t stop = std::max(chunkStart, lowest);
+            for (size_t i = pos; i-- > stop; )
+                (*this)[i] = (*this)[i - b];
+            pos = stop;
+        }
+    }
+    std::copy(moving.begin(), moving.end(), begin() + insertPos);
+}
@@ -0,0 +1,391 @@
+#include "PmergeMe.hpp"
+#include <ctime>
+#include <iomanip>
+#include <sys/resource.h>
+
+// wall clock that never jumps (clock() measures CPU time of the whole process)
+double PmergeMe::monotonicSeconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// largest resident set of the process so far in kB (Linux reports ru_maxrss in kB)
+long PmergeMe::peakRssKb()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return -1;
+    return usage.ru_maxrss;
+}
+
+// reproducible random input (xorshift32), values in [0, INT_MAX]
+std::vector<unsigned int> PmergeMe::randomSequence(size_t n, unsigned int seed)
+{
+    std::vector<unsigned int> seq;
+    unsigned int state = seed ? seed : 1;
+
+    seq.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        seq.push_back(state & 0x7fffffffu);
+    }
+    return seq;
+}
+
+/*
+Insertion backend benchmark (--insert-bench [maxN]):
+
+Sorts random inputs of 10^3 ... maxN elements with the rotate and the indexed insertion backend.
+Both have to make exactly the same comparisons, only the data movement differs.
+The rotate backend is quadratic, it is skipped above ROTATE_BENCH_LIMIT elements.
+The rotate backend on a TieredVector moves every block in O(sqrt(n)), it is skipped above TIERED_BENCH_LIMIT.
+With threads > 1 the indexed backend also runs multithreaded (same comparisons again).
+*/
+void PmergeMe::runInsertBenchmark(size_t maxN, unsigned int threads)
+{
+    const size_t ROTATE_BENCH_LIMIT = 100000;
+    const size_t TIERED_BENCH_LIMIT = 1000000;
+
+    std::cout << std::setw(10) << "n" << std::setw(16) << "rotate (ms)" << std::setw(16) << "indexed (ms)"
+              << std::setw(10) << "speedup"
+              << std::setw(16) << "tiered (ms)";
+    if (threads > 1)
+        std::cout << std::setw(12) << threads << " threads" << std::setw(10) << "speedup";
+    std::cout << std::setw(16) << "comparisons" << "  check" << std::endl;
+    for (size_t n = 1000; n <= maxN; n *= 10)
+    {
+        std::vector<unsigned int> input = randomSequence(n, static_cast<unsigned int>(n));
+
+        std::vector<unsigned int> indexed = input;
+        VectorEngine indexedEngine;
+        indexedEngine.setInsertBackend(VectorEngine::INDEXED_INSERT);
+        double start = monotonicSeconds();
+        indexedEngine.sort(indexed);
+        double indexedMs = (monotonicSeconds() - start) * 1000;
+        bool ok = isSorted(indexed);
+
+        std::cout << std::fixed << std::setprecision(2) << std::setw(10) << n;
+        if (n <= ROTATE_BENCH_LIMIT) {
+            std::vector<unsigned int> rotated = input;
+            VectorEngine rotateEngine;
+            rotateEngine.setInsertBackend(VectorEngine::ROTATE_INSERT);
+            start = monotonicSeconds();
+            rotateEngine.sort(rotated);
+            double rotateMs = (monotonicSeconds() - start) * 1000;
+            ok = ok && rotated == indexed && rotateEngine.counter().count() == indexedEngine.counter().count();
+            std::cout << std::setw(16) << rotateMs << std::setw(16) << indexedMs << std::setw(9) << rotateMs / indexedMs << "x";
+        } else {
+            std::cout << std::setw(16) << "skipped" << std::setw(16) << indexedMs << std::setw(10) << "-";
+        }
+        if (n <= TIERED_BENCH_LIMIT) {
+            TieredVector<unsigned int> tiered;
+            tiered.assign(input.begin(), input.end());
+            TieredEngine tieredEngine;
+            tieredEngine.setInsertBackend(TieredEngine::ROTATE_INSERT);
+            start = monotonicSeconds();
+            tieredEngine.sort(tiered);
+            double tieredMs = (monotonicSeconds() - start) * 1000;
+            ok = ok && std::equal(indexed.begin(), indexed.end(), tiered.begin())
+                && tieredEngine.counter().count() == indexedEngine.counter().count();
+            std::cout << std::setw(16) << tieredMs;
+        } else {
+            std::cout << std::setw(16) << "skipped";
+        }
+        if (threads > 1) {
+            std::vector<unsigned int> parallel = input;
+            VectorEngine parallelEngine;
+            parallelEngine.setInsertBackend(VectorEngine::INDEXED_INSERT);
+            parallelEngine.setThreads(threads);
+            start = monotonicSeconds();
+            parallelEngine.sort(parallel);
+            double parallelMs = (monotonicSeconds() - start) * 1000;
+            ok = ok && parallel == indexed && parallelEngine.counter().count() == indexedEngine.counter().count();
+            std::cout << std::setw(17) << parallelMs << " ms" << std::setw(9) << indexedMs / parallelMs << "x";
+        }
+        std::cout << std::setw(16) << indexedEngine.counter().count() << "  " << (ok ? "OK" : "FAILED") << std::endl;
+        if (n > maxN / 10) // avoid overflow of n *= 10
+            break;
+    }
+}
+
+// std::less that counts its calls, for the algorithms of the standard library
+struct CountingLess
+{
+    unsigned long* calls;
+
+    explicit CountingLess(unsigned long* calls) : calls(calls) {}
+    bool operator()(unsigned int a, unsigned int b) const { ++*calls; return a < b; }
+};
+
+/*
+Selection benchmark (--select-bench [n]):
+
+Comparisons of Selection (Floyd-Rivest with a Ford-Johnson sample) against std::nth_element
+and std::partial_sort on the same input, for several k:
+- nth element: next to n + min(k, n - k), the expected optimum of Floyd and Rivest
+- top-k (sorted): next to log2(n! / (n - k)!), the number of bits needed to name the result
+  (for distinct values, with duplicates fewer bits suffice)
+The input is random, then duplicate heavy (2 and 4 distinct values).
+Every result is checked against std::sort.
+*/
+void PmergeMe::runSelectionBenchmark(size_t n)
+{
+    if (n < 2)
+        n = 2;
+    const unsigned int distinctValues[] = {0, 2, 4}; // 0: random values
+    size_t ks[] = {1, 10, 100, n / 100, n / 10, n / 2};
+
+    std::cout << "n = " << n << std::endl;
+    for (size_t d = 0; d < sizeof(distinctValues) / sizeof(distinctValues[0]); ++d)
+    {
+        std::vector<unsigned int> input = randomSequence(n, 11);
+        if (distinctValues[d] == 0) {
+            std::cout << "random values" << std::endl;
+        } else {
+            std::cout << distinctValues[d] << " distinct values" << std::endl;
+            for (size_t i = 0; i < n; ++i)
+                input[i] %= distinctValues[d];
+        }
+        std::vector<unsigned int> sorted = input;
+        std::sort(sorted.begin(), sorted.end());
+
+        std::cout << std::setw(10) << "k" << std::setw(12) << "FJ nth" << std::setw(18) << "std::nth_element"
+                  << std::setw(14) << "n+min(k,n-k)" << std::setw(12) << "FJ top-k" << std::setw(18) << "std::partial_sort"
+                  << std::setw(14) << "info bound" << "  check" << std::endl;
+        for (size_t i = 0; i < sizeof(ks) / sizeof(ks[0]); ++i)
+        {
+            size_t k = ks[i];
+            if (k == 0 || k >= n)
+                continue;
+            Selection selection;
+
+            std::vector<unsigned int> nth = input;
+            selection.nthElement(nth, k);
+            unsigned long nthComparisons = selection.comparisonCount();
+            bool ok = nth[k] == sorted[k];
+
+            std::vector<unsigned int> stdNth = input;
+            unsigned long stdNthComparisons = 0;
+            std::nth_element(stdNth.begin(), stdNth.begin() + k, stdNth.end(), CountingLess(&stdNthComparisons));
+
+            std::vector<unsigned int> top = input;
+            selection.resetCounter();
+            selection.topK(top, k);
+            unsigned long topComparisons = selection.comparisonCount();
+            ok = ok && std::equal(sorted.begin(), sorted.begin() + k, top.begin());
+
+            std::vector<unsigned int> stdTop = input;
+            unsigned long stdTopComparisons = 0;
+            std::partial_sort(stdTop.begin(), stdTop.begin() + k, stdTop.end(), CountingLess(&stdTopComparisons));
+
+            double bits = 0;
+            for (size_t j = n - k + 1; j <= n; ++j)
+                bits += std::log(static_cast<double>(j)) / std::log(2.0);
+
+            std::cout << std::setw(10) << k << std::setw(12) << nthComparisons << std::setw(18) << stdNthComparisons
+                      << std::setw(14) << n + std::min(k, n - k) << std::setw(12) << topComparisons
+                      << std::setw(18) << stdTopComparisons << std::setw(14) << static_cast<unsigned long>(std::ceil(bits))
+                      << "  " << (ok ? "OK" : "FAILED") << std::endl;
+        }
+    }
+}
+
+/*
+Small sort kernel benchmark (--small-bench):
+
+Sorts many random inputs of every size with the engine's rounds down to single elements
+(cutoff 0) and with the small sort kernels (default cutoff SMALL_SORT_MAX), about 2 million
+elements per size and engine. Prints the time per element and the comparisons per sort,
+every result is checked against std::sort.
+*/
+void PmergeMe::runSmallSortBenchmark()
+{
+    const size_t sizes[] = {2, 4, 8, 12, 16, 32, 64, 256, 1024, 10000, 100000};
+    const size_t ELEMENTS_PER_SIZE = 2000000;
+
+    std::cout << std::setw(10) << "n" << std::setw(12) << "sorts" << std::setw(20) << "rounds (ns/elem)"
+              << std::setw(20) << "kernels (ns/elem)" << std::setw(10) << "speedup"
+              << std::setw(16) << "comparisons" << std::setw(16) << "with kernels" << "  check" << std::endl;
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+    {
+        size_t n = sizes[i];
+        size_t sorts = ELEMENTS_PER_SIZE / n;
+        std::vector<unsigned int> all = randomSequence(n * sorts, static_cast<unsigned int>(n));
+        std::vector<unsigned int> expected = all;
+        for (size_t s = 0; s < sorts; ++s)
+            std::sort(expected.begin() + s * n, expected.begin() + (s + 1) * n);
+
+        double ns[2];
+        unsigned long comparisons[2];
+        bool ok = true;
+        for (int withKernels = 0; withKernels < 2; ++withKernels)
+        {
+            VectorEngine engine;
+            engine.setSmallSortCutoff(withKernels ? SMALL_SORT_MAX : 0);
+            std::vector<unsigned int> data(n);
+            std::vector<unsigned int> sorted;
+            sorted.reserve(all.size());
+            double start = monotonicSeconds();
+            for (size_t s = 0; s < sorts; ++s)
+            {
+                data.assign(all.begin() + s * n, all.begin() + (s + 1) * n);
+                engine.sort(data);
+                sorted.insert(sorted.end(), data.begin(), data.end());
+            }
+            ns[withKernels] = (monotonicSeconds() - start) * 1e9 / all.size();
+            comparisons[withKernels] = engine.counter().count() / sorts;
+            ok = ok && sorted == expected;
+        }
+
+        std::cout << std::fixed << std::setprecision(1) << std::setw(10) << n << std::setw(12) << sorts
+                  << std::setw(20) << ns[0] << std::setw(20) << ns[1] << std::setw(9) << ns[0] / ns[1] << "x"
+                  << std::setw(16) << comparisons[0] << std::setw(16) << comparisons[1]
+                  << "  " << (ok ? "OK" : "FAILED") << std::endl;
+    }
+}
+
+namespace
+{
+    // throughput of one record layout on sorts slices of n records, with the block sizes known
+    // at run time and at compile time
+    template <typename Engine, typename T, typename KeyOf>
+    void benchKeyWidth(const std::string& layout, const std::vector<T>& input, size_t n, const KeyOf& keyOf)
+    {
+        const int REPS = 3;
+        size_t sorts = input.size() / n;
+        std::vector<T> expected = input;
+        for (size_t s = 0; s < sorts; ++s)
+            std::sort(expected.begin() + s * n, expected.begin() + (s + 1) * n);
+
+        double seconds[2];
+        unsigned long comparisons[2];
+        bool ok = true;
+        for (int fixed = 0; fixed < 2; ++fixed)
+        {
+            Engine engine(keyOf);
+            engine.setFixedBlocks(fixed != 0);
+            std::vector<T> data(n);
+            seconds[fixed] = 0;
+            for (int rep = 0; rep < REPS; ++rep) // best of REPS
+            {
+                engine.resetCounter();
+                double elapsed = 0;
+                for (size_t s = 0; s < sorts; ++s)
+                {
+                    data.assign(input.begin() + s * n, input.begin() + (s + 1) * n);
+                    double start = PmergeMe::monotonicSeconds();
+                    engine.sort(data);
+                    elapsed += PmergeMe::monotonicSeconds() - start;
+
+                    for (size_t i = 1; i < n && ok; ++i)
+                        ok = !(keyOf(data[i]) < keyOf(data[i - 1]));
+                    std::sort(data.begin(), data.end()); // same records (the payloads of equal keys may swap)
+                    ok = ok && std::equal(data.begin(), data.end(), expected.begin() + s * n);
+                }
+                if (rep == 0 || elapsed < seconds[fixed])
+                    seconds[fixed] = elapsed;
+            }
+            comparisons[fixed] = engine.counter().count() / sorts;
+        }
+        ok = ok && comparisons[0] == comparisons[1];
+
+        double records = static_cast<double>(input.size());
+        std::cout << std::fixed << std::setprecision(2) << std::setw(10) << n << std::setw(14) << layout
+                  << std::setw(8) << sizeof(T) << std::setw(16) << records / seconds[0] / 1e6
+                  << std::setw(14) << records / seconds[1] / 1e6 << std::setw(9) << seconds[0] / seconds[1] << "x"
+                  << std::setw(10) << records * sizeof(T) / seconds[1] / 1e6
+                  << std::setw(14) << comparisons[1] << "  " << (ok ? "OK" : "FAILED") << std::endl;
+    }
+}
+
+/*
+Key width benchmark (--width-bench [max_n]):
+
+Sorts random records of every layout the engine is instantiated for with std::vector,
+n = 10^2 ... max_n, max_n records per size (many small sorts for small n):
+- u32:    unsigned int keys
+- u64:    unsigned long long keys over the whole 64-bit range
+- packed: 32-bit key + 32-bit payload (the input position) in one 64-bit word, PackedKey
+Every layout runs with the block sizes only known at run time and with the fixed block sizes of
+the lower levels (setFixedBlocks), same comparisons. Throughput in million records (M/s) and
+megabytes (MB/s) per second.
+*/
+void PmergeMe::runKeyWidthBenchmark(size_t maxN)
+{
+    std::vector<unsigned int> keys = randomSequence(maxN, 42);
+    std::vector<unsigned long long> wide(maxN);
+    std::vector<unsigned long long> packed(maxN);
+    unsigned long long state = 88172645463325252ULL; // xorshift64
+    for (size_t i = 0; i < maxN; ++i)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        wide[i] = state;
+        packed[i] = static_cast<unsigned long long>(keys[i]) << 32 | static_cast<unsigned int>(i);
+    }
+
+    std::cout << std::setw(10) << "n" << std::setw(14) << "layout" << std::setw(8) << "bytes"
+              << std::setw(16) << "runtime (M/s)" << std::setw(14) << "fixed (M/s)" << std::setw(10) << "speedup"
+              << std::setw(10) << "MB/s" << std::setw(14) << "comparisons" << "  check" << std::endl;
+    for (size_t n = 100; n <= maxN; n *= 10)
+    {
+        size_t records = maxN / n * n;
+        std::vector<unsigned int> keysN(keys.begin(), keys.begin() + records);
+        std::vector<unsigned long long> wideN(wide.begin(), wide.begin() + records);
+        std::vector<unsigned long long> packedN(packed.begin(), packed.begin() + records);
+        benchKeyWidth<VectorEngine>("u32", keysN, n, IdentityKey<unsigned int>());
+        benchKeyWidth<WideVectorEngine>("u64", wideN, n, IdentityKey<unsigned long long>());
+        benchKeyWidth<PackedVectorEngine>("packed 32+32", packedN, n, PackedKey<unsigned long long, 32>());
+    }
+}
+
+/*
+Crossover benchmark (--crossover-bench [n]):
+
+Sorts the same random input with merge-insertion and introsort while every comparison gets
+more expensive (CostlyLess), and shows which engine the calibrated SortPlanner picks.
+Radix does not use the comparator, its time is shown once for the natural order.
+*/
+void PmergeMe::runCrossoverBenchmark(size_t n)
+{
+    const double costs[] = {0, 5, 20, 50, 100, 200, 500, 1000, 2000, 5000};
+    std::vector<unsigned int> input = randomSequence(n, 7);
+    SortPlanner planner;
+    planner.calibrate();
+
+    std::vector<unsigned int> radix = input;
+    double start = monotonicSeconds();
+    RadixSort::sort(radix);
+    std::cout << "n = " << n << ", radix (natural order only): " << std::fixed << std::setprecision(2)
+              << (monotonicSeconds() - start) * 1000 << " ms" << std::endl;
+
+    std::cout << std::setw(12) << "compare ns" << std::setw(22) << "merge-insertion (ms)" << std::setw(16) << "introsort (ms)"
+              << std::setw(18) << "faster" << std::setw(18) << "planner picks" << std::endl;
+    for (size_t i = 0; i < sizeof(costs) / sizeof(costs[0]); ++i)
+    {
+        CostlyLess compare(SortPlanner::spinsForCost(costs[i]));
+        planner.setComparatorCost(costs[i]);
+        SortPlanner::Plan plan = planner.choose(n, false);
+
+        std::vector<unsigned int> fj = input;
+        FordJohnson<std::vector<unsigned int>, IdentityKey<unsigned int>, CostlyLess> engine(IdentityKey<unsigned int>(), compare);
+        start = monotonicSeconds();
+        engine.sort(fj);
+        double fjMs = (monotonicSeconds() - start) * 1000;
+
+        std::vector<unsigned int> intro = input;
+        start = monotonicSeconds();
+        std::sort(intro.begin(), intro.end(), compare);
+        double introMs = (monotonicSeconds() - start) * 1000;
+
+        std::cout << std::setw(12) << costs[i] << std::setw(22) << fjMs << std::setw(16) << introMs
+                  << std::setw(18) << (fjMs < introMs ? "merge-insertion" : "introsort")
+                  << std::setw(18) << SortPlanner::engineName(plan.engine)
+                  << (fj == intro && fj == radix ? "" : "  RESULTS DIFFER") << std::endl;
+    }
+}
@@ -1,18 +1,218 @@
 #include "PmergeMe.hpp"
+#include "ExternalSort.hpp"
+#include "Metrics.hpp"
 
 int main(int ac, char **av)
 {
+    if (!Metrics::takeFlag(ac, av, "PmergeMe"))
+        return 1;
     if (ac < 2) 
     {
         std::cerr << "Error: No arguments provided" << std::endl;
         std::cerr << "Usage: ./PmergeMe <positive_integer1> <positive_integer2> ..." << std::endl;
         std::cerr << "Example: ./PmergeMe 11 2 17 0 16 8 6 15 10 3 21 1 18 9 14 19 12 5 4 20 13" << std::endl;
+        std::cerr << "From a file: ./PmergeMe --file <path> | --mmap <path> | --stdin" << std::endl;
+        std::cerr << "Multithreaded: ./PmergeMe --threads <n> <positive_integer1> ..." << std::endl;
+        std::cerr << "Hardware counters per phase: ./PmergeMe --perf <positive_integer1> ..." << std::endl;
+        std::cerr << "Vector only, in place, peak RSS: ./PmergeMe --lean <positive_integer1> ..." << std::endl;
+        std::cerr << "Presorted runs / few unique keys: ./PmergeMe --adaptive <positive_integer1> ..." << std::endl;
+        std::cerr << "Small sort cutoff in blocks: ./PmergeMe --small-sort <n> <positive_integer1> ... (0 = off, max 16)" << std::endl;
+        std::cerr << "External sort: ./PmergeMe --external <input> <output> [--run-elements N] [--tmp <dir>] [--compare-cost <ns>]" << std::endl;
+        std::cerr << "Selection: ./PmergeMe --nth <k> | --top <k> <positive_integer1> ... (k from 0 for --nth)" << std::endl;
+        std::cerr << "Selection benchmark: ./PmergeMe --select-bench [n] (default 1000000)" << std::endl;
+        std::cerr << "Small sort kernel benchmark: ./PmergeMe --small-bench" << std::endl;
+        std::cerr << "64-bit keys: ./PmergeMe --u64 <positive_integer1> ... (up to 18446744073709551615)" << std::endl;
+        std::cerr << "Key width benchmark: ./PmergeMe --width-bench [max_n] (default 100000)" << std::endl;
+        std::cerr << "Online batches: ./PmergeMe --incremental <batch_size> <positive_integer1> ..." << std::endl;
+        std::cerr << "Engine chosen by cost model: ./PmergeMe --auto [--compare-cost <ns>] <positive_integer1> ..." << std::endl;
+        std::cerr << "Insertion backend benchmark: ./PmergeMe --insert-bench [max_n] [threads] (default 10000000 1)" << std::endl;
+        std::cerr << "Engine crossover benchmark: ./PmergeMe --crossover-bench [n] (default 20000)" << std::endl;
+        std::cerr << "Benchmark sweep: ./PmergeMe --bench [--sizes 1000,10000] [--dist random,sorted,reversed,few-unique,organ-pipe]" << std::endl;
+        std::cerr << "                 [--warmup N] [--reps N] [--seed N] [--format csv|json]" << std::endl;
+        std::cerr << "Timers and counters as JSON on stderr: ./PmergeMe --metrics=json <any of the above>" << std::endl;
         return 1;
     }
+    if (std::string(av[1]) == "--crossover-bench")
+    {
+        PmergeMe::runCrossoverBenchmark(ac > 2 ? std::strtoul(av[2], NULL, 10) : 20000);
+        return 0;
+    }
+    if (std::string(av[1]) == "--insert-bench")
+    {
+        size_t maxN = ac > 2 ? std::strtoul(av[2], NULL, 10) : 10000000;
+        unsigned int threads = ac > 3 ? std::strtoul(av[3], NULL, 10) : 1;
+        PmergeMe::runInsertBenchmark(maxN, threads);
+        return 0;
+    }
+    if (std::string(av[1]) == "--select-bench")
+    {
+        PmergeMe::runSelectionBenchmark(ac > 2 ? std::strtoul(av[2], NULL, 10) : 1000000);
+        return 0;
+    }
+    if (std::string(av[1]) == "--small-bench")
+    {
+        PmergeMe::runSmallSortBenchmark();
+        return 0;
+    }
+    if (std::string(av[1]) == "--width-bench")
+    {
+        PmergeMe::runKeyWidthBenchmark(ac > 2 ? std::strtoul(av[2], NULL, 10) : 100000);
+        return 0;
+    }
     PmergeMe mergeInsertSort;
+    if (std::string(av[1]) == "--bench")
+    {
+        PmergeMe::SweepOptions options;
+        for (int i = 2; i < ac; )
+        {
+            int used = PmergeMe::parseSweepOption(ac, av, i, options);
+            if (used == 0) {
+                std::cerr << "Error: invalid benchmark option " << av[i] << std::endl;
+                return 1;
+            }
+            i += used;
+        }
+        try {
+            mergeInsertSort.runSweepBenchmark(options);
+        } catch (std::exception &e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    if (std::string(av[1]) == "--external")
+    {
+        if (ac < 4) {
+            std::cerr << "Error: --external needs an input and an output file" << std::endl;
+            return 1;
+        }
+        ExternalSort::Options options;
+        for (int i = 4; i < ac; i += 2)
+        {
+            std::string option = av[i];
+            if (i + 1 >= ac) {
+                std::cerr << "Error: " << option << " needs a value" << std::endl;
+                return 1;
+            }
+            if (option == "--run-elements")
+                options.runElements = std::strtoul(av[i + 1], NULL, 10);
+            else if (option == "--tmp")
+                options.tmpDir = av[i + 1];
+            else if (option == "--compare-cost")
+                options.compare = CostlyLess(SortPlanner::spinsForCost(std::strtod(av[i + 1], NULL)));
+            else {
+                std::cerr << "Error: invalid external sort option " << option << std::endl;
+                return 1;
+            }
+        }
+        try {
+            ExternalSort sorter(options);
+            sorter.sort(av[2], av[3]);
+            sorter.report(std::cout);
+        } catch (std::exception &e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    if (std::string(av[1]) == "--nth" || std::string(av[1]) == "--top")
+    {
+        if (ac < 4) {
+            std::cerr << "Error: " << av[1] << " needs k and a sequence" << std::endl;
+            return 1;
+        }
+        bool topK = std::string(av[1]) == "--top";
+        size_t k = std::strtoul(av[2], NULL, 10);
+        av[2] = av[0]; // checkArgs skips av[0]
+        try {
+            mergeInsertSort.runSelection(ac - 2, av + 2, k, topK);
+        } catch (std::exception &e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    if (std::string(av[1]) == "--incremental")
+    {
+        if (ac < 4) {
+            std::cerr << "Error: --incremental needs a batch size and a sequence" << std::endl;
+            return 1;
+        }
+        size_t batchSize = std::strtoul(av[2], NULL, 10);
+        av[2] = av[0]; // checkArgs skips av[0]
+        try {
+            mergeInsertSort.runIncrementalSort(ac - 2, av + 2, batchSize);
+        } catch (std::exception &e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    if (std::string(av[1]) == "--auto")
+    {
+        double compareCost = -1;
+        int skip = 1;
+        if (ac > 3 && std::string(av[2]) == "--compare-cost") {
+            compareCost = std::strtod(av[3], NULL);
+            skip = 3;
+        }
+        if (ac - skip < 2) {
+            std::cerr << "Error: --auto needs a sequence" << std::endl;
+            return 1;
+        }
+        av[skip] = av[0]; // checkArgs skips av[0]
+        try {
+            mergeInsertSort.runPlannedSort(ac - skip, av + skip, compareCost);
+        } catch (std::exception &e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    // options in front of the sequence: --threads N, --small-sort N, --perf, --lean, --adaptive
+    while (ac > 1 && (std::string(av[1]) == "--threads" || std::string(av[1]) == "--small-sort"
+                      || std::string(av[1]) == "--perf" || std::string(av[1]) == "--lean"
+                      || std::string(av[1]) == "--adaptive"))
+    {
+        int used = 1;
+        if (std::string(av[1]) == "--perf") {
+            mergeInsertSort.setPerf(true);
+        } else if (std::string(av[1]) == "--lean") {
+            mergeInsertSort.setLean(true);
+        } else if (std::string(av[1]) == "--adaptive") {
+            mergeInsertSort.setAdaptive(true);
+        } else if (ac <= 2) {
+            std::cerr << "Error: " << av[1] << " needs a number" << std::endl;
+            return 1;
+        } else if (std::string(av[1]) == "--small-sort") {
+            mergeInsertSort.setSmallSort(std::strtoul(av[2], NULL, 10));
+            used = 2;
+        } else {
+            mergeInsertSort.setThreads(std::strtoul(av[2], NULL, 10));
+            used = 2;
+        }
+        av[used] = av[0]; // checkArgs skips av[0]
+        ac -= used;
+        av += used;
+    }
+    if (ac < 2)
+    {
+        std::cerr << "Error: No arguments provided" << std::endl;
+        return 1;
+    }
     try
     {
-        mergeInsertSort.runMergeInsertSort(ac, av);
+        std::string mode = av[1];
+        if (mode == "--stdin")
+            mergeInsertSort.runMergeInsertSort(InputReader::FROM_STDIN, "");
+        else if ((mode == "--file" || mode == "--mmap") && ac == 3)
+            mergeInsertSort.runMergeInsertSort(mode == "--file" ? InputReader::FROM_FILE : InputReader::FROM_MMAP, av[2]);
+        else if (mode == "--u64") {
+            av[1] = av[0]; // the parser skips av[0]
+            mergeInsertSort.runWideSort(ac - 1, av + 1);
+        }
+        else
+            mergeInsertSort.runMergeInsertSort(ac, av);
     }
     catch (std::exception &e)
     {
@@ -0,0 +1,11 @@
+#include "PmergeMe.hpp"
+#include "Metrics.hpp"
+
+static const size_t SORT_SIMD = Metrics::define("pmerge.simd", Metrics::TIMER);
+
+// execution of the SIMD engine on std::vector (cheap keys, no comparison counting)
+void PmergeMe::sortVecSimd(std::vector<unsigned int>& vec) 
+{
+    ScopedTimer timer(SORT_SIMD);
+    SimdSort::sort(vec);
+}
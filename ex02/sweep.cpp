@@ -0,0 +1,226 @@
+#include "PmergeMe.hpp"
+#include <iomanip>
+
+/*
+Benchmark sweep (--bench [options]):
+
+For every distribution and size the same input is sorted by every engine:
+    warmup runs (not measured) -> repetitions timed on the monotonic clock -> statistics
+The input is copied before every run, the copy is not part of the time. No sequence is printed.
+
+Reported per engine/distribution/size:
+- median, p95, min, max and the median absolute deviation (mad) of the times in microseconds
+- comparisons per element of the Ford-Johnson engines next to maxComparisonsFJ(n) / n
+  (the comparison count is deterministic, it is taken from the first repetition)
+
+Options:
+    --sizes 1000,10000          input sizes
+    --dist random,sorted,...    random, sorted, reversed, few-unique, organ-pipe
+    --warmup N --reps N         warmup runs and measured repetitions per cell
+    --seed N                    seed of the random inputs
+    --format csv|json           output format (default csv)
+*/
+
+PmergeMe::SweepOptions::SweepOptions()
+    : warmup(2), reps(11), seed(42), json(false)
+{
+    sizes.push_back(1000);
+    sizes.push_back(10000);
+    sizes.push_back(100000);
+    const char* all[] = {"random", "sorted", "reversed", "few-unique", "organ-pipe"};
+    distributions.assign(all, all + 5);
+}
+
+namespace
+{
+    std::vector<std::string> splitList(const std::string& list)
+    {
+        std::vector<std::string> items;
+        std::string::size_type start = 0;
+        while (start <= list.size()) {
+            std::string::size_type comma = list.find(',', start);
+            if (comma == std::string::npos)
+                comma = list.size();
+            if (comma > start)
+                items.push_back(list.substr(start, comma - start));
+            start = comma + 1;
+        }
+        return items;
+    }
+
+    // value at the given fraction of the sorted samples (nearest rank)
+    double percentile(const std::vector<double>& sorted, double fraction)
+    {
+        size_t rank = static_cast<size_t>(fraction * sorted.size() + 0.999999);
+        if (rank == 0)
+            rank = 1;
+        return sorted[std::min(rank, sorted.size()) - 1];
+    }
+
+    struct Summary
+    {
+        double median, p95, min, max, mad;
+    };
+
+    Summary summarize(std::vector<double> samples)
+    {
+        Summary s;
+        std::sort(samples.begin(), samples.end());
+        s.median = percentile(samples, 0.5);
+        s.p95 = percentile(samples, 0.95);
+        s.min = samples.front();
+        s.max = samples.back();
+        std::vector<double> deviations;
+        for (size_t i = 0; i < samples.size(); ++i)
+            deviations.push_back(samples[i] > s.median ? samples[i] - s.median : s.median - samples[i]);
+        std::sort(deviations.begin(), deviations.end());
+        s.mad = percentile(deviations, 0.5);
+        return s;
+    }
+}
+
+// parses one option of the sweep, returns the number of arguments used (0 = unknown option)
+int PmergeMe::parseSweepOption(int ac, char **av, int i, SweepOptions& options)
+{
+    std::string name = av[i];
+    if (i + 1 >= ac)
+        return 0;
+    std::string value = av[i + 1];
+
+    if (name == "--sizes") {
+        std::vector<std::string> items = splitList(value);
+        options.sizes.clear();
+        for (size_t k = 0; k < items.size(); ++k)
+            options.sizes.push_back(std::strtoul(items[k].c_str(), NULL, 10));
+    } else if (name == "--dist") {
+        options.distributions = splitList(value);
+    } else if (name == "--warmup") {
+        options.warmup = std::strtoul(value.c_str(), NULL, 10);
+    } else if (name == "--reps") {
+        options.reps = std::strtoul(value.c_str(), NULL, 10);
+    } else if (name == "--seed") {
+        options.seed = std::strtoul(value.c_str(), NULL, 10);
+    } else if (name == "--format" && (value == "csv" || value == "json")) {
+        options.json = value == "json";
+    } else {
+        return 0;
+    }
+    return 2;
+}
+
+// reproducible input of the given distribution
+std::vector<unsigned int> PmergeMe::makeSequence(const std::string& distribution, size_t n, unsigned int seed)
+{
+    std::vector<unsigned int> seq = randomSequence(n, seed);
+
+    if (distribution == "sorted") {
+        std::sort(seq.begin(), seq.end());
+    } else if (distribution == "reversed") {
+        std::sort(seq.begin(), seq.end());
+        std::reverse(seq.begin(), seq.end());
+    } else if (distribution == "few-unique") {
+        for (size_t i = 0; i < n; ++i)
+            seq[i] &= 15; // 16 distinct values
+    } else if (distribution == "organ-pipe") {
+        for (size_t i = 0; i < n; ++i)
+            seq[i] = static_cast<unsigned int>(i < n / 2 ? i : n - 1 - i); // 0 1 2 ... 2 1 0
+    } else if (distribution != "random") {
+        throw std::runtime_error("Error: unknown distribution " + distribution);
+    }
+    return seq;
+}
+
+// times one engine on one input: warmup, repetitions, summary line
+void PmergeMe::sweepEngine(const std::string& engine, const std::string& distribution,
+                           const std::vector<unsigned int>& input, const SweepOptions& options, bool& first)
+{
+    std::vector<double> samples;
+    unsigned long comparisons = 0;
+    bool sorted = true;
+
+    for (unsigned int run = 0; run < options.warmup + options.reps; ++run)
+    {
+        std::vector<unsigned int> vec;
+        std::deque<unsigned int> deq;
+        TieredVector<unsigned int> tiered;
+        double start = 0;
+        resetComparisonCount();
+
+        if (engine == "deque") {
+            deq.assign(input.begin(), input.end());
+            start = monotonicSeconds();
+            sortDequeFordJohnson(deq);
+        } else if (engine == "tiered") {
+            tiered.assign(input.begin(), input.end());
+            start = monotonicSeconds();
+            sortTieredFordJohnson(tiered);
+        } else {
+            vec.assign(input.begin(), input.end());
+            start = monotonicSeconds();
+            if (engine == "vector")
+                sortVecFordJohnson(vec);
+            else if (engine == "adaptive")
+                sortVecAdaptive(vec);
+            else
+                sortVecSimd(vec);
+        }
+        double elapsed = (monotonicSeconds() - start) * 1e6;
+
+        if (run < options.warmup)
+            continue;
+        samples.push_back(elapsed);
+        if (run == options.warmup) {
+            comparisons = getComparisonCount();
+            if (engine == "deque")
+                sorted = isSorted(deq);
+            else
+                sorted = engine == "tiered" ? isSorted(tiered) : isSorted(vec);
+        }
+    }
+
+    Summary s = summarize(samples);
+    size_t n = input.size();
+    double perElement = engine == "simd" ? 0 : static_cast<double>(comparisons) / n;
+    double boundPerElement = static_cast<double>(maxComparisonsFJ(n)) / n;
+
+    std::cout << std::fixed << std::setprecision(3);
+    if (options.json) {
+        std::cout << (first ? "[\n" : ",\n") << "  {\"engine\": \"" << engine << "\", \"distribution\": \"" << distribution
+                  << "\", \"n\": " << n << ", \"reps\": " << options.reps << ", \"median_us\": " << s.median
+                  << ", \"p95_us\": " << s.p95 << ", \"min_us\": " << s.min << ", \"max_us\": " << s.max
+                  << ", \"mad_us\": " << s.mad << ", \"comparisons_per_element\": " << perElement
+                  << ", \"fj_bound_per_element\": " << boundPerElement << ", \"sorted\": " << (sorted ? "true" : "false") << "}";
+    } else {
+        if (first)
+            std::cout << "engine,distribution,n,reps,median_us,p95_us,min_us,max_us,mad_us,"
+                      << "comparisons_per_element,fj_bound_per_element,sorted" << std::endl;
+        std::cout << engine << "," << distribution << "," << n << "," << options.reps << "," << s.median << ","
+                  << s.p95 << "," << s.min << "," << s.max << "," << s.mad << "," << perElement << ","
+                  << boundPerElement << "," << (sorted ? "yes" : "no") << std::endl;
+    }
+    first = false;
+}
+
+void PmergeMe::runSweepBenchmark(const SweepOptions& options)
+{
+    const char* engines[] = {"deque", "vector", "tiered", "adaptive", "simd"};
+    bool first = true;
+
+    if (options.reps == 0)
+        throw std::runtime_error("Error: --reps must be at least 1");
+    for (size_t d = 0; d < options.distributions.size(); ++d)
+        makeSequence(options.distributions[d], 1, options.seed); // unknown names fail before any output
+    for (size_t d = 0; d < options.distributions.size(); ++d)
+    {
+        for (size_t i = 0; i < options.sizes.size(); ++i)
+        {
+            if (options.sizes[i] == 0)
+                continue;
+            std::vector<unsigned int> input = makeSequence(options.distributions[d], options.sizes[i], options.seed);
+            for (size_t e = 0; e < sizeof(engines) / sizeof(engines[0]); ++e)
+                sweepEngine(engines[e], options.distributions[d], input, options, first);
+        }
+    }
+    if (options.json)
+        std::cout << (first ? "[" : "") << "\n]" << std::endl;
+}
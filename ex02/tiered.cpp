@@ -0,0 +1,29 @@
+#include "PmergeMe.hpp"
+#include "Metrics.hpp"
+
+static const size_t SORT_TIERED = Metrics::define("pmerge.tiered", Metrics::TIMER);
+static const size_t COMPARISONS = Metrics::define("pmerge.comparisons", Metrics::COUNTER);
+
+// execution of the Ford-Johnson algorithm on TieredVector (every round inserts through the rings)
+void PmergeMe::sortTieredFordJohnson(TieredVector<unsigned int>& tiered) 
+{
+    ScopedTimer timer(SORT_TIERED);
+    if (perf) {
+        TieredPerfEngine engine;
+        engine.setInsertBackend(TieredPerfEngine::ROTATE_INSERT);
+        engine.setThreads(threads);
+        engine.setSmallSortCutoff(small_sort);
+        engine.sort(tiered);
+        comparison_count += engine.counter().count();
+        Metrics::add(COMPARISONS, engine.counter().count());
+        engine.probe().report(perf_report, "TieredVector");
+        return;
+    }
+    TieredEngine engine;
+    engine.setInsertBackend(TieredEngine::ROTATE_INSERT);
+    engine.setThreads(threads);
+    engine.setSmallSortCutoff(small_sort);
+    engine.sort(tiered);
+    comparison_count += engine.counter().count();
+    Metrics::add(COMPARISONS, engine.counter().count());
+}
@@ -1,7 +1,7 @@
 #include "PmergeMe.hpp"
 
 // Constructor
-PmergeMe::PmergeMe(void) {}
+PmergeMe::PmergeMe(void) : threads(1), perf(false), lean(false), adaptive(false), small_sort(SMALL_SORT_MAX) {}
 
 // Destructor
 PmergeMe::~PmergeMe(void) {}
@@ -20,10 +20,35 @@ PmergeMe &PmergeMe::operator=(const PmergeMe &other)
    return *this;
 }
 
+void PmergeMe::setThreads(unsigned int newThreads)
+{
+    threads = newThreads ? newThreads : 1;
+}
+
+void PmergeMe::setPerf(bool enabled)
+{
+    perf = enabled;
+}
+
+void PmergeMe::setLean(bool enabled)
+{
+    lean = enabled;
+}
+
+void PmergeMe::setAdaptive(bool enabled)
+{
+    adaptive = enabled;
+}
+
+void PmergeMe::setSmallSort(size_t blocks)
+{
+    small_sort = blocks;
+}
+
 // tracks the total number of comparisons made during sorting
-int PmergeMe::comparison_count = 0;
+unsigned long PmergeMe::comparison_count = 0;
 
-int PmergeMe::getComparisonCount() 
+unsigned long PmergeMe::getComparisonCount() 
 {
     return comparison_count;
 }
@@ -48,54 +73,20 @@ Total: 0+1+2+2+2 = 7 comparisons maximum
 
 maxComparisons = Σ(k=1 to n) ceil(log2(3k/4))
 */
-int PmergeMe::maxComparisonsFJ(int n) 
+unsigned long PmergeMe::maxComparisonsFJ(size_t n) 
 {
-    int sum = 0;
-    for (int k = 1; k <= n; ++k) {
+    unsigned long sum = 0;
+    for (size_t k = 1; k <= n; ++k) {
         double value = (3.0 / 4.0) * k;
-        sum += static_cast<int>(ceil(log2(value)));
+        sum += static_cast<unsigned long>(ceil(log2(value)));
     }
     return sum;
 }
 
-// parse through the input and check that it only includes valid integers
+// parse the arguments into pmerge_vector (PmergeMe.tpp)
 void PmergeMe::checkArgs(int ac, char **av) 
 {
-    for (int i = 1; i < ac; i++) 
-    {
-        std::istringstream iss(av[i]);
-        int pmerge_int;
-        
-        // iss.peek() == EOF ensures no extra characters after the number (e.g. 12a would pass otherwise)
-        if (iss >> pmerge_int && iss.peek() == EOF && pmerge_int >= 0)
-        {
-            pmerge_deque.push_back(pmerge_int);
-        }
-        else
-            throw std::runtime_error("Please provide valid numeric positive arguments.");
-    }
-}
-
-// print the sequence for vector
-void PmergeMe::printSequence(const std::string& label, const std::vector<unsigned int>& seq) 
-{
-    std::cout << label;
-    for (size_t i = 0; i < seq.size(); ++i) {
-        std::cout << seq[i];
-        if (i < seq.size() - 1) std::cout << " ";
-    }
-    std::cout << std::endl;
-}
-
-// print the sequence for deque
-void PmergeMe::printSequence(const std::string& label, const std::deque<unsigned int>& seq) 
-{
-    std::cout << label;
-    for (size_t i = 0; i < seq.size(); ++i) {
-        std::cout << seq[i];
-        if (i < seq.size() - 1) std::cout << " ";
-    }
-    std::cout << std::endl;
+    checkArgs(ac, av, pmerge_vector);
 }
 
 // check if vector is sorted in ascending order
@@ -120,12 +111,28 @@ bool PmergeMe::isSorted(const std::deque<unsigned int>& deq)
     return true;
 }
 
-// verify both containers are sorted and print results
-void PmergeMe::verifySorting(const std::vector<unsigned int>& vec, const std::deque<unsigned int>& deq) 
+// check if the tiered vector is sorted in ascending order
+bool PmergeMe::isSorted(const TieredVector<unsigned int>& tiered) 
+{
+    for (size_t i = 1; i < tiered.size(); ++i) {
+        if (tiered[i] < tiered[i-1]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// verify all containers are sorted and print results
+void PmergeMe::verifySorting(const std::vector<unsigned int>& vec, const std::deque<unsigned int>& deq,
+                             const TieredVector<unsigned int>& tiered, const std::vector<unsigned int>& simd) 
 {
     bool vector_sorted = isSorted(vec);
     bool deque_sorted = isSorted(deq);
+    bool tiered_sorted = isSorted(tiered);
+    bool simd_sorted = isSorted(simd);
     
     std::cout << "Vector is sorted: " << (vector_sorted ? "YES" : "NO") << std::endl;
     std::cout << "Deque is sorted:  " << (deque_sorted ? "YES" : "NO") << std::endl;
+    std::cout << "Tiered is sorted: " << (tiered_sorted ? "YES" : "NO") << std::endl;
+    std::cout << "SIMD is sorted:   " << (simd_sorted ? "YES" : "NO") << std::endl;
 }
\ No newline at end of file
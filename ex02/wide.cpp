@@ -0,0 +1,47 @@
+#include "PmergeMe.hpp"
+
+namespace
+{
+    template <typename Container>
+    bool isSortedWide(const Container& seq)
+    {
+        return std::adjacent_find(seq.begin(), seq.end(), std::greater<unsigned long long>()) == seq.end();
+    }
+}
+
+/*
+64-bit keys (--u64 ...): the same Ford-Johnson engines instantiated for unsigned long long,
+so IDs up to 18446744073709551615 sort without being cut to 32 bits. Reports the same lines as
+the default mode for std::vector and std::deque (--threads and --small-sort apply).
+*/
+void PmergeMe::runWideSort(int ac, char **av)
+{
+    std::vector<unsigned long long> vec;
+    checkArgs(ac, av, vec);
+    std::deque<unsigned long long> deq(vec.begin(), vec.end());
+    printSequence("Before: ", vec);
+
+    WideDequeEngine dequeEngine;
+    dequeEngine.setThreads(threads);
+    dequeEngine.setSmallSortCutoff(small_sort);
+    clock_t c_start_deque = clock();
+    dequeEngine.sort(deq);
+    double cpu_time_deque = double(clock() - c_start_deque) / CLOCKS_PER_SEC * 1000000;
+
+    WideVectorEngine vectorEngine;
+    vectorEngine.setThreads(threads);
+    vectorEngine.setSmallSortCutoff(small_sort);
+    clock_t c_start_vector = clock();
+    vectorEngine.sort(vec);
+    double cpu_time_vector = double(clock() - c_start_vector) / CLOCKS_PER_SEC * 1000000;
+
+    printSequence("After deque:  ", deq);
+    printSequence("After vector: ", vec);
+    std::cout << "Time to process a range of " << deq.size() << " 64-bit elements with std::deque : " << cpu_time_deque << " us" << std::endl;
+    std::cout << "Time to process a range of " << vec.size() << " 64-bit elements with std::vector : " << cpu_time_vector << " us" << std::endl;
+    unsigned long max_comparisons = maxComparisonsFJ(vec.size());
+    std::cout << "Number of comparisons with std::deque vs. theoretical limit:  " << dequeEngine.counter().count() << " / " << max_comparisons << std::endl;
+    std::cout << "Number of comparisons with std::vector vs. theoretical limit: " << vectorEngine.counter().count() << " / " << max_comparisons << std::endl;
+    bool sorted = isSortedWide(vec) && isSortedWide(deq) && std::equal(vec.begin(), vec.end(), deq.begin());
+    std::cout << "Vector and deque are sorted: " << (sorted ? "YES" : "NO") << std::endl;
+}